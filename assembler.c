@@ -0,0 +1,166 @@
+/**
+ * This file contains the text front end of the assembler and the back end it shares with the builder API. The text
+ * front end pre-processes a source file and runs the first pass on the extended source to build the statement list,
+ * and the back end runs the optional optimization passes, the second pass and the output writers on that list.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include "assembler.h"
+#include "utils.h"
+#include "globals.h"
+#include "pre_asm.h"
+#include "first_pass.h"
+#include "second_pass.h"
+#include "output_files.h"
+#include "optimizer.h"
+#include "expression.h"
+#include "report.h"
+#include "cycle_cost.h"
+#include "symbol_structs.h"
+#include "statement_structs.h"
+
+/**
+ * Runs the back end of the assembler on the statement list: the optional optimization passes, the folding of the
+ * expressions, the second pass and the output writers. It is shared by the text front end and the builder API.
+ *
+ * @param name              The base name of the output files.
+ * @param first_success     Indicates if the statement list was built without errors.
+ *
+ * @return True if there were errors, False otherwise.
+ *
+ * @remarks The function frees the symbol table, the extern table, the statement table and the expressions.
+ */
+boolean finish_assembly(char *name, boolean first_success) {
+    boolean second_success = TRUE;
+
+    /* Perform the optimization passes only on a program without errors */
+    if (first_success && is_elimination_enabled) {
+        printf("%s: Unreachable code and unused data elimination removed %d words\n", name, eliminate_unreachable());
+    }
+
+    if (first_success && is_dedup_enabled) {
+        printf("%s: Data deduplication saved %d words\n", name, merge_identical_data());
+    }
+
+    if (first_success && is_peephole_enabled) {
+        printf("%s: Peephole optimization saved %d words\n", name, optimize_peephole());
+    }
+
+    /* Print the size report of the program as it will be written, after the optimization passes */
+    if (first_success && is_size_report_enabled) {
+        print_size_report(name);
+    }
+
+    /* Print the cycle estimate of the routines, whose control flow is final after the optimization passes */
+    if (first_success && is_cycle_report_enabled) {
+        print_cycle_report(name);
+    }
+
+    /* Print the call profile of the worst case paths */
+    if (first_success && is_call_profile_enabled) {
+        print_call_profile(name);
+    }
+
+    /* Fold the expressions that depend on the symbol addresses, which are final after the optimization passes */
+    if (first_success && !fold_expressions()) {
+        print_error(FIRST_PASS_FAILED);
+        first_success = FALSE;
+    }
+
+    /* Open the listing file, which the second pass writes while it encodes the statements */
+    if (first_success && is_listing_enabled) {
+        listing_fd = open_listing_file(name);
+    }
+
+    /* Perform the second processing pass on the statements */
+    if (second_process()) {
+        print_error(SECOND_PASS_FAILED);
+        second_success = FALSE;
+    }
+
+    if (listing_fd != NULL) {
+        close_listing_file(listing_fd, name, second_success);
+        listing_fd = NULL;
+    }
+
+    /* Only if all passes succeeded write the .ob, .ent, and .ext output files (the image stays in memory in memory mode) */
+    if (first_success && second_success && is_memory_mode) {
+        printf("%s: Assembled in memory: %d code words, %d data words\n", name, ic, dc);
+    } else if (first_success && second_success) {
+        create_output_files(name);
+
+        /* The folded stacks of the call profile are written with the output files */
+        if (is_call_profile_enabled) {
+            write_call_profile(name);
+        }
+    }
+
+    /* Free the memory used by the symbol table */
+    free_symbol(&symbol_table);
+
+    /* Free the memory used by the extern table */
+    free_ext(&ext_table);
+
+    /* Free the memory used by the statement table */
+    free_stmt(&stmt_table);
+
+    /* Free the memory used by the expressions and the constant table */
+    free_expressions();
+
+    /* Free the memory used by the expansion sites of the size report */
+    free_expansion_sites();
+
+    return !(first_success && second_success);
+}
+
+/**
+ * Prints the time spent in each stage of the assembly of a program.
+ *
+ * @param name          The name of the program.
+ * @param start_time    The processor time before the pre-processing.
+ * @param pre_time      The processor time after the pre-processing.
+ * @param first_time    The processor time after the first pass.
+ * @param end_time      The processor time after the optimization passes, the second pass and the outputs.
+ */
+void print_timing(char *name, clock_t start_time, clock_t pre_time, clock_t first_time, clock_t end_time) {
+    printf("%s: Time: pre-processing %.3f ms, first pass %.3f ms, second pass %.3f ms, total %.3f ms\n", name,
+           (pre_time - start_time) * 1000.0 / CLOCKS_PER_SEC, (first_time - pre_time) * 1000.0 / CLOCKS_PER_SEC,
+           (end_time - first_time) * 1000.0 / CLOCKS_PER_SEC, (end_time - start_time) * 1000.0 / CLOCKS_PER_SEC);
+}
+
+/**
+ * Assembles a source file with the text front end: pre-processes it, runs the first pass on the extended source and
+ * runs the back end on the resulting statement list.
+ *
+ * @param name The name of the source file (without an extension).
+ */
+void assemble_source(char *name) {
+    boolean first_success = TRUE;
+    clock_t start_time;
+    clock_t pre_time;
+    clock_t first_time;
+
+    /* Pre-process the source file */
+    start_time = clock();
+    if (!(pre_process(name))) {
+        print_error(MCR_EXP_FAILED);
+        return;
+    }
+
+    /* Perform the first processing pass on the extended source */
+    pre_time = clock();
+    if (first_process(name)) {
+        print_error(FIRST_PASS_FAILED);
+        first_success = FALSE;
+    }
+
+    /* Run the optional optimization passes, the second pass and the output writers, and free the tables */
+    first_time = clock();
+    finish_assembly(name, first_success);
+
+    /* In memory mode the assembly of many small programs is timed, to find where the time goes */
+    if (is_memory_mode) {
+        print_timing(name, start_time, pre_time, first_time, clock());
+    }
+}
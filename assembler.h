@@ -0,0 +1,16 @@
+/**
+ * This header file declares the functions of the text front end of the assembler and of the back end it shares with
+ * the builder API.
+ */
+
+#ifndef ASM_ASSEMBLER_H
+#define ASM_ASSEMBLER_H
+
+#include <time.h>
+#include "utils.h"
+
+boolean finish_assembly(char *, boolean);
+void print_timing(char *, clock_t, clock_t, clock_t, clock_t);
+void assemble_source(char *);
+
+#endif
\ No newline at end of file
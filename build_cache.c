@@ -0,0 +1,723 @@
+/**
+ * This file contains the implementation of the build cache. The daemon listens on a Unix domain socket and serves one
+ * request per connection, with the numbers and byte strings of the coordinator protocol:
+ *
+ * - GET_CACHE_REQUEST, a key and an identity: answered by 1 and the result (as sent by send_result_files), or 0 on a
+ *   miss.
+ * - PUT_CACHE_REQUEST, a key, an identity and a result: stores the result under the key, with no answer.
+ * - STATS_CACHE_REQUEST: answered by the hits, misses, stores, evictions, entries, size and capacity of the cache.
+ *
+ * The key is a hash of the identity, the options, name and source bytes the result depends on. The daemon stores the
+ * identity with the result and answers a GET only if the identities are equal, so two sources whose hashes collide
+ * cannot get each other's result.
+ *
+ * The entries are kept in a list from the most to the least recently used, and the least recently used entries are
+ * evicted until a new entry fits the capacity. An assembler that cannot reach the daemon assembles as usual.
+ *
+ * The daemon serves a single user: its socket is only accessible to the user who runs it.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "build_cache.h"
+#include "utils.h"
+#include "globals.h"
+#include "assembler.h"
+#include "coordinator.h"
+#include "optimizer.h"
+
+/* Definition of a result stored in the cache */
+struct cache_entry {
+    char key[MAX_CACHE_KEY_LEN]; /* The key of the result */
+    char *identity; /* The options, name and source bytes the result was assembled from */
+    long identity_len; /* The number of bytes of the identity */
+    int part_count; /* The number of parts of the result */
+    long part_types[MAX_CACHE_PARTS]; /* The file type of each part, or OUTPUT_PART for the output of the assembler */
+    char *parts[MAX_CACHE_PARTS]; /* The bytes of each part */
+    long part_lengths[MAX_CACHE_PARTS]; /* The number of bytes of each part */
+    long size; /* The number of bytes the entry counts for in the capacity of the cache */
+    Entryptr prev; /* Pointer to the more recently used entry */
+    Entryptr next; /* Pointer to the less recently used entry */
+};
+
+static char *option_key = ""; /* The options that change the results of the assembler, part of every key */
+
+static Entryptr lru_head; /* The most recently used entry */
+static Entryptr lru_tail; /* The least recently used entry */
+static long cache_size; /* The number of bytes of the entries */
+static long cache_capacity; /* The number of bytes the entries can take */
+static long entry_count; /* The number of entries */
+static long hit_count; /* The number of GET requests answered by an entry */
+static long miss_count; /* The number of GET requests without an entry */
+static long store_count; /* The number of entries stored */
+static long eviction_count; /* The number of entries evicted to make room for new ones */
+static volatile sig_atomic_t is_daemon_stopping; /* Set by the signals that stop the daemon */
+
+/**
+ * Builds the part of the keys that comes from the options, which change the results of the assembler. The options
+ * that only choose how the files are assembled (-P, -B, -T, -I, -K and -Y) are left out.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments.
+ */
+void build_option_key(int argc, char *argv[]) {
+    long length = 1;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        length += (long)strlen(argv[i]) + 1;
+    }
+
+    option_key = (char *)malloc(length * sizeof(char));
+    if (option_key == NULL) {
+        print_error(MEM_ALLOC_FAILED);
+        exit(1);
+    }
+
+    option_key[0] = '\0';
+    for (i = 1; i < argc; i++) {
+        if (argv[i][0] == '-' && strchr("PBTIKY", argv[i][1]) == NULL) {
+            strcat(option_key, argv[i]);
+            strcat(option_key, " ");
+        }
+    }
+}
+
+/**
+ * Makes the identity of a source file: the options, the name and the bytes of the source file, each of the first two
+ * followed by a null character. The result of the assembler depends on nothing else.
+ *
+ * @param name          The name of the source file (without an extension), which the output of the assembler holds.
+ * @param source        The bytes of the source file.
+ * @param source_len    The number of bytes of the source file.
+ * @param identity_len  Set to the number of bytes of the identity.
+ *
+ * @return A dynamically allocated buffer holding the identity.
+ */
+char *make_cache_identity(char *name, char *source, long source_len, long *identity_len) {
+    long option_len = (long)strlen(option_key) + 1;
+    long name_len = (long)strlen(name) + 1;
+    char *identity;
+
+    *identity_len = option_len + name_len + source_len;
+    identity = (char *)malloc(*identity_len * sizeof(char));
+    if (identity == NULL) {
+        print_error(MEM_ALLOC_FAILED);
+        exit(1);
+    }
+
+    memcpy(identity, option_key, (size_t)option_len);
+    memcpy(identity + option_len, name, (size_t)name_len);
+    memcpy(identity + option_len + name_len, source, (size_t)source_len);
+
+    return identity;
+}
+
+/**
+ * Makes the cache key of an identity: two 32-bit hashes (FNV-1a and djb2) of its bytes, followed by its length. The
+ * key only finds the entry, which the daemon then checks against the identity.
+ *
+ * @param identity      The identity of the source file.
+ * @param identity_len  The number of bytes of the identity.
+ * @param key           The buffer the key is written into (MAX_CACHE_KEY_LEN characters).
+ */
+void make_cache_key(char *identity, long identity_len, char *key) {
+    unsigned long fnv_hash = FNV_OFFSET_BASIS;
+    unsigned long djb_hash = 5381;
+    long i;
+
+    for (i = 0; i < identity_len; i++) {
+        fnv_hash = ((fnv_hash ^ (unsigned char)identity[i]) * FNV_PRIME) & 0xFFFFFFFFUL;
+        djb_hash = ((djb_hash << 5) + djb_hash + (unsigned char)identity[i]) & 0xFFFFFFFFUL;
+    }
+
+    sprintf(key, "%08lx%08lx-%lx", fnv_hash, djb_hash, (unsigned long)identity_len);
+}
+
+/**
+ * Connects to the cache daemon.
+ *
+ * @return The connected socket, or -1 if the daemon cannot be reached.
+ */
+int connect_cache(void) {
+    struct sockaddr_un address;
+    int fd;
+
+    if (strlen(cache_path) >= sizeof(address.sun_path)) {
+        return -1;
+    }
+
+    /* A daemon that stops in the middle of a request must not stop the assembler */
+    signal(SIGPIPE, SIG_IGN);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, cache_path);
+
+    if (connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ * Queries the cache daemon for the result of a source file, and on a hit writes its files and prints its output.
+ *
+ * @param name          The name of the source file (without an extension).
+ * @param key           The key of the source file.
+ * @param identity      The identity of the source file.
+ * @param identity_len  The number of bytes of the identity.
+ *
+ * @return TRUE on a hit, FALSE on a miss or if the daemon cannot be reached.
+ */
+boolean query_cache(char *name, char *key, char *identity, long identity_len) {
+    int fd = connect_cache();
+    char *output;
+    long output_len = 0;
+    long found;
+
+    if (fd < 0) {
+        return FALSE;
+    }
+
+    if (!send_number(fd, GET_CACHE_REQUEST) || !send_bytes(fd, key, (long)strlen(key)) ||
+        !send_bytes(fd, identity, identity_len) || !receive_number(fd, &found) || found != 1) {
+        close(fd);
+        return FALSE;
+    }
+
+    /* The files of the result replace all the files of the source file, as an assembly would */
+    remove_result_files(name);
+    if (!receive_result_files(fd, name, MAX_TRANSFER_LEN, &output, &output_len)) {
+        close(fd);
+        return FALSE;
+    }
+    close(fd);
+
+    fwrite(output, 1, (size_t)output_len, stdout);
+    free(output);
+
+    return TRUE;
+}
+
+/**
+ * Publishes the result of a source file to the cache daemon.
+ *
+ * @param name          The name of the source file (without an extension).
+ * @param key           The key of the source file.
+ * @param identity      The identity of the source file.
+ * @param identity_len  The number of bytes of the identity.
+ * @param output        The output of the assembler.
+ * @param output_len    The number of characters of the output.
+ */
+void publish_cache(char *name, char *key, char *identity, long identity_len, char *output, long output_len) {
+    int fd = connect_cache();
+
+    if (fd < 0) {
+        return;
+    }
+
+    if (send_number(fd, PUT_CACHE_REQUEST) && send_bytes(fd, key, (long)strlen(key)) &&
+        send_bytes(fd, identity, identity_len)) {
+        send_result_files(fd, name, output, output_len);
+    }
+    close(fd);
+}
+
+/**
+ * Assembles a source file through the cache: replays the result of the daemon on a hit, and otherwise assembles the
+ * file while capturing its output, and publishes the result.
+ *
+ * @param name The name of the source file (without an extension).
+ */
+void assemble_cached(char *name) {
+    char *modified_filename_source = generate_new_filename(name, FILE_SOURCE);
+    char key[MAX_CACHE_KEY_LEN];
+    char *source;
+    char *identity;
+    char *output;
+    long source_len = 0;
+    long identity_len;
+    long output_len;
+    FILE *capture_fd;
+    int saved_fd;
+
+    source = read_whole_file(modified_filename_source, &source_len);
+    free(modified_filename_source);
+
+    /* A missing source is reported by the assembler, and not cached */
+    if (source == NULL) {
+        assemble_source(name);
+        return;
+    }
+
+    identity = make_cache_identity(name, source, source_len, &identity_len);
+    make_cache_key(identity, identity_len, key);
+    free(source);
+
+    if (query_cache(name, key, identity, identity_len)) {
+        free(identity);
+        return;
+    }
+
+    /* Capture the output of the assembler, which is part of the result */
+    fflush(stdout);
+    capture_fd = tmpfile();
+    saved_fd = capture_fd == NULL ? -1 : dup(STDOUT_FILENO);
+    if (saved_fd < 0 || dup2(fileno(capture_fd), STDOUT_FILENO) < 0) {
+        if (saved_fd >= 0) {
+            close(saved_fd);
+        }
+        if (capture_fd != NULL) {
+            fclose(capture_fd);
+        }
+        free(identity);
+        assemble_source(name);
+        return;
+    }
+
+    /* Only the files of this assembly belong to the result */
+    remove_result_files(name);
+    assemble_source(name);
+
+    fflush(stdout);
+    dup2(saved_fd, STDOUT_FILENO);
+    close(saved_fd);
+
+    fseek(capture_fd, 0, SEEK_END);
+    output_len = ftell(capture_fd);
+    rewind(capture_fd);
+
+    output = (char *)malloc((output_len + 1) * sizeof(char));
+    if (output == NULL) {
+        print_error(MEM_ALLOC_FAILED);
+        exit(1);
+    }
+    output_len = (long)fread(output, 1, (size_t)output_len, capture_fd);
+    fclose(capture_fd);
+
+    fwrite(output, 1, (size_t)output_len, stdout);
+    publish_cache(name, key, identity, identity_len, output, output_len);
+    free(identity);
+    free(output);
+}
+
+/**
+ * Prints the metrics of the cache.
+ *
+ * @param hits          The number of GET requests answered by an entry.
+ * @param misses        The number of GET requests without an entry.
+ * @param stores        The number of entries stored.
+ * @param evictions     The number of entries evicted.
+ * @param entries       The number of entries.
+ * @param size          The number of bytes of the entries.
+ * @param capacity      The number of bytes the entries can take.
+ */
+void print_cache_metrics(long hits, long misses, long stores, long evictions, long entries, long size, long capacity) {
+    printf("Build cache: %ld hits, %ld misses (%ld%% hit rate), %ld stores, %ld evictions, %ld entries, "
+           "%ld of %ld bytes\n", hits, misses, hits + misses > 0 ? hits * 100 / (hits + misses) : 0, stores, evictions,
+           entries, size, capacity);
+}
+
+/**
+ * Queries the cache daemon for its metrics and prints them.
+ */
+void print_cache_stats(void) {
+    int fd = connect_cache();
+    long values[7];
+    int i;
+
+    if (fd < 0 || !send_number(fd, STATS_CACHE_REQUEST)) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        print_error(CACHE_UNAVAILABLE);
+        return;
+    }
+
+    for (i = 0; i < 7; i++) {
+        if (!receive_number(fd, &values[i])) {
+            close(fd);
+            print_error(CACHE_UNAVAILABLE);
+            return;
+        }
+    }
+    close(fd);
+
+    print_cache_metrics(values[0], values[1], values[2], values[3], values[4], values[5], values[6]);
+}
+
+/**
+ * Finds the entry of a key.
+ *
+ * @param key The key.
+ *
+ * @return A pointer to the entry, or NULL if the cache has no entry for the key.
+ */
+Entryptr find_cache_entry(char *key) {
+    Entryptr entry;
+
+    for (entry = lru_head; entry != NULL; entry = entry->next) {
+        if (strcmp(entry->key, key) == 0) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Adds an entry to the front of the list of entries, as the most recently used.
+ *
+ * @param entry The entry, which is not in the list.
+ */
+void push_cache_entry(Entryptr entry) {
+    entry->prev = NULL;
+    entry->next = lru_head;
+
+    if (lru_head != NULL) {
+        lru_head->prev = entry;
+    } else {
+        lru_tail = entry;
+    }
+    lru_head = entry;
+}
+
+/**
+ * Removes an entry from the list of entries.
+ *
+ * @param entry The entry.
+ */
+void unlink_cache_entry(Entryptr entry) {
+    if (entry->prev != NULL) {
+        entry->prev->next = entry->next;
+    } else {
+        lru_head = entry->next;
+    }
+
+    if (entry->next != NULL) {
+        entry->next->prev = entry->prev;
+    } else {
+        lru_tail = entry->prev;
+    }
+
+    entry->prev = NULL;
+    entry->next = NULL;
+}
+
+/**
+ * Frees the memory used by an entry, which is not in the list of entries.
+ *
+ * @param entry The entry.
+ */
+void free_cache_entry(Entryptr entry) {
+    int i;
+
+    for (i = 0; i < entry->part_count; i++) {
+        free(entry->parts[i]);
+    }
+    free(entry->identity);
+    free(entry);
+}
+
+/**
+ * Evicts the least recently used entries until an entry of the given size fits the capacity.
+ *
+ * @param size The number of bytes of the new entry.
+ */
+void evict_cache_entries(long size) {
+    Entryptr entry;
+
+    while (lru_tail != NULL && cache_size + size > cache_capacity) {
+        entry = lru_tail;
+        unlink_cache_entry(entry);
+        cache_size -= entry->size;
+        entry_count--;
+        eviction_count++;
+        free_cache_entry(entry);
+    }
+}
+
+/**
+ * Receives a result sent by send_result_files into a new entry.
+ *
+ * @param fd            The socket.
+ * @param key           The key of the result.
+ * @param identity      The identity of the result, which the entry takes over (freed if no entry is made).
+ * @param identity_len  The number of bytes of the identity.
+ *
+ * @return A pointer to the new entry, or NULL if the result was not received, does not fit the capacity of the cache
+ *         or does not fit in memory.
+ */
+Entryptr receive_cache_entry(int fd, char *key, char *identity, long identity_len) {
+    Entryptr entry;
+    long part_count;
+
+    if (!receive_number(fd, &part_count) || part_count < 1 || part_count > MAX_CACHE_PARTS) {
+        free(identity);
+        return NULL;
+    }
+
+    /* A client must not stop the daemon, so a failed allocation only drops the result */
+    entry = (Entryptr)malloc(sizeof(CacheEntry));
+    if (entry == NULL) {
+        print_error(MEM_ALLOC_FAILED);
+        free(identity);
+        return NULL;
+    }
+
+    strcpy(entry->key, key);
+    entry->identity = identity;
+    entry->identity_len = identity_len;
+    entry->part_count = 0;
+    entry->size = (long)(sizeof(CacheEntry)) + identity_len;
+    entry->prev = NULL;
+    entry->next = NULL;
+
+    for (entry->part_count = 0; entry->part_count < part_count; entry->part_count++) {
+        if (!receive_number(fd, &entry->part_types[entry->part_count])) {
+            free_cache_entry(entry);
+            return NULL;
+        }
+
+        /* Each part can only take what is left of the capacity, so a large length is not allocated */
+        entry->parts[entry->part_count] = receive_bytes(fd, cache_capacity - entry->size,
+                                                        &entry->part_lengths[entry->part_count]);
+        if (entry->parts[entry->part_count] == NULL) {
+            free_cache_entry(entry);
+            return NULL;
+        }
+
+        entry->size += entry->part_lengths[entry->part_count];
+    }
+
+    return entry;
+}
+
+/**
+ * Sends the result of an entry, as send_result_files does.
+ *
+ * @param fd    The socket.
+ * @param entry The entry.
+ *
+ * @return TRUE if the result was sent, FALSE otherwise.
+ */
+boolean send_cache_entry(int fd, Entryptr entry) {
+    boolean success = send_number(fd, entry->part_count);
+    int i;
+
+    for (i = 0; i < entry->part_count; i++) {
+        success = success && send_number(fd, entry->part_types[i]) &&
+                  send_bytes(fd, entry->parts[i], entry->part_lengths[i]);
+    }
+
+    return success;
+}
+
+/**
+ * Serves the request of a connection to the daemon.
+ *
+ * @param fd The connected socket.
+ */
+void serve_cache_request(int fd) {
+    Entryptr entry;
+    Entryptr old_entry;
+    char *key = NULL;
+    char *identity;
+    long request;
+    long key_len;
+    long identity_len;
+
+    if (!receive_number(fd, &request)) {
+        return;
+    }
+
+    if (request == STATS_CACHE_REQUEST) {
+        if (send_number(fd, hit_count) && send_number(fd, miss_count) && send_number(fd, store_count) &&
+            send_number(fd, eviction_count) && send_number(fd, entry_count) && send_number(fd, cache_size)) {
+            send_number(fd, cache_capacity);
+        }
+        return;
+    }
+
+    key = receive_bytes(fd, MAX_CACHE_KEY_LEN - 1, &key_len);
+    if (key == NULL) {
+        return;
+    }
+
+    /* An identity larger than the cache cannot belong to an entry */
+    identity = receive_bytes(fd, cache_capacity, &identity_len);
+    if (identity == NULL) {
+        free(key);
+        return;
+    }
+
+    if (request == GET_CACHE_REQUEST) {
+        /* An entry whose identity differs only shares the hashes of the key, and is a miss */
+        entry = find_cache_entry(key);
+        if (entry != NULL && (entry->identity_len != identity_len ||
+                              memcmp(entry->identity, identity, (size_t)identity_len) != 0)) {
+            entry = NULL;
+        }
+        free(identity);
+
+        if (entry == NULL) {
+            miss_count++;
+            send_number(fd, 0);
+        } else {
+            /* Move the entry to the front of the list, as the most recently used */
+            hit_count++;
+            unlink_cache_entry(entry);
+            push_cache_entry(entry);
+
+            if (send_number(fd, 1)) {
+                send_cache_entry(fd, entry);
+            }
+        }
+    } else if (request != PUT_CACHE_REQUEST) {
+        free(identity);
+    } else if ((entry = receive_cache_entry(fd, key, identity, identity_len)) != NULL) {
+        old_entry = find_cache_entry(key);
+        if (old_entry != NULL) {
+            unlink_cache_entry(old_entry);
+            cache_size -= old_entry->size;
+            entry_count--;
+            free_cache_entry(old_entry);
+        }
+
+        /* A result larger than the whole cache is not stored */
+        if (entry->size > cache_capacity) {
+            free_cache_entry(entry);
+        } else {
+            evict_cache_entries(entry->size);
+            push_cache_entry(entry);
+
+            cache_size += entry->size;
+            entry_count++;
+            store_count++;
+        }
+    }
+
+    free(key);
+}
+
+/**
+ * Handles the signals that stop the daemon.
+ *
+ * @param signal_number The signal.
+ */
+void stop_cache_daemon(int signal_number) {
+    (void)signal_number;
+    is_daemon_stopping = TRUE;
+}
+
+/**
+ * Runs the cache daemon until it receives SIGINT or SIGTERM, and prints its metrics.
+ *
+ * @param argument The path of the socket, optionally followed by a comma and the capacity of the cache in bytes.
+ */
+void run_cache_daemon(char *argument) {
+    struct sockaddr_un address;
+    struct sigaction action;
+    struct timeval timeout;
+    Entryptr entry;
+    char *comma = strrchr(argument, ',');
+    mode_t old_mask;
+    boolean is_bound;
+    int listen_fd;
+    int fd;
+
+    cache_capacity = DEFAULT_CACHE_CAPACITY;
+    if (comma != NULL) {
+        *comma = '\0';
+        cache_capacity = atol(comma + 1);
+    }
+
+    /* The capacity is sent in the metrics, as a number of the protocol */
+    if (*argument == '\0' || cache_capacity <= 0 || cache_capacity > MAX_NUMBER ||
+        strlen(argument) >= sizeof(address.sun_path)) {
+        print_error(CACHE_DAEMON_FAILED);
+        return;
+    }
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        print_error(CACHE_DAEMON_FAILED);
+        return;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, argument);
+
+    /* A socket left by a daemon that did not stop cleanly is replaced */
+    unlink(argument);
+
+    /* The socket is created for the user only (mode 0600), other users could otherwise store forged results */
+    old_mask = umask(0177);
+    is_bound = bind(listen_fd, (struct sockaddr *)&address, sizeof(address)) == 0;
+    umask(old_mask);
+
+    if (!is_bound || listen(listen_fd, CACHE_BACKLOG) != 0) {
+        close(listen_fd);
+        print_error(CACHE_DAEMON_FAILED);
+        return;
+    }
+
+    /* The signals interrupt accept, so the loop sees the flag */
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = stop_cache_daemon;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = 0;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    printf("Build cache: listening on %s, %ld bytes\n", argument, cache_capacity);
+    fflush(stdout);
+
+    /* A client that stops sending cannot hold the daemon longer than the timeout */
+    timeout.tv_sec = CACHE_TIMEOUT_SECONDS;
+    timeout.tv_usec = 0;
+
+    while (!is_daemon_stopping) {
+        fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) {
+            continue;
+        }
+
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        serve_cache_request(fd);
+        close(fd);
+    }
+
+    close(listen_fd);
+    unlink(argument);
+
+    print_cache_metrics(hit_count, miss_count, store_count, eviction_count, entry_count, cache_size, cache_capacity);
+
+    while (lru_head != NULL) {
+        entry = lru_head;
+        unlink_cache_entry(entry);
+        free_cache_entry(entry);
+    }
+}
@@ -0,0 +1,49 @@
+/**
+ * This header file declares the functions of the build cache. The cache daemon keeps the results of assemblies (the
+ * output of the assembler and the files it wrote) in memory, keyed by a hash of the source file, its name and the
+ * options and checked against those bytes on a hit, and evicts the least recently used results beyond its capacity.
+ * The assembler queries the daemon before assembling a source file and publishes the result after, so concurrent
+ * builds share their results.
+ */
+
+#ifndef ASM_BUILD_CACHE_H
+#define ASM_BUILD_CACHE_H
+
+#include "utils.h"
+
+#define MAX_CACHE_KEY_LEN 40
+#define MAX_CACHE_PARTS 8
+#define DEFAULT_CACHE_CAPACITY (64L * 1024 * 1024)
+#define CACHE_TIMEOUT_SECONDS 5
+#define CACHE_BACKLOG 16
+
+/* Enumeration for the requests of the cache protocol */
+typedef enum cache_request { GET_CACHE_REQUEST, PUT_CACHE_REQUEST, STATS_CACHE_REQUEST } cache_request;
+
+/* Forward declaration of the struct cache_entry */
+typedef struct cache_entry CacheEntry;
+
+/* Pointer to the struct cache_entry */
+typedef CacheEntry *Entryptr;
+
+void build_option_key(int, char *[]);
+char *make_cache_identity(char *, char *, long, long *);
+void make_cache_key(char *, long, char *);
+int connect_cache(void);
+boolean query_cache(char *, char *, char *, long);
+void publish_cache(char *, char *, char *, long, char *, long);
+void assemble_cached(char *);
+void print_cache_metrics(long, long, long, long, long, long, long);
+void print_cache_stats(void);
+Entryptr find_cache_entry(char *);
+void push_cache_entry(Entryptr);
+void unlink_cache_entry(Entryptr);
+void free_cache_entry(Entryptr);
+void evict_cache_entries(long);
+Entryptr receive_cache_entry(int, char *, char *, long);
+boolean send_cache_entry(int, Entryptr);
+void serve_cache_request(int);
+void stop_cache_daemon(int);
+void run_cache_daemon(char *);
+
+#endif
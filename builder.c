@@ -0,0 +1,319 @@
+/**
+ * This file contains the implementation of the builder API of the assembler. A program generator calls the emit
+ * functions in the order of the statements of the program, and each call validates its statement with the same
+ * rules and tables as the first pass and records it directly in the statement list, the symbol table and the code
+ * and data segments. Calling end_program then runs the same back end as the text front end (see assembler.c).
+ */
+
+#include <string.h>
+#include "builder.h"
+#include "assembler.h"
+#include "utils.h"
+#include "globals.h"
+#include "first_pass.h"
+#include "symbol_structs.h"
+#include "statement_structs.h"
+
+/* Definition of a symbol in the symbol table (linked list) */
+struct symbol {
+    char name[MAX_SYMBOL_LEN]; /* The name of the symbol */
+    unsigned int address; /* The address associated with the symbol */
+    statement_type type; /* The type of statement the symbol belongs to */
+    boolean is_ext; /* Indicates if the symbol is an external symbol */
+    boolean is_ent; /* Indicates if the symbol is an entry symbol */
+    Symbolptr next; /* Pointer to the next symbol in the symbol table */
+};
+
+/* Definition of a statement in the statement list (linked list) */
+struct stmt {
+    int line_num; /* The line number of the statement in the extended source file */
+    char *source; /* A copy of the source line of the statement (kept only for the listing file), or NULL */
+    char label[MAX_SYMBOL_LEN + 1]; /* The symbol defined by the statement, or an empty string */
+    statement_type type; /* The type of the statement (instruction, directive) */
+    opcode op; /* The opcode of an instruction statement */
+    directive dir; /* The directive of a directive statement */
+    char src[MAX_OPERAND_LEN + 1]; /* The source operand, or an empty string */
+    char dest[MAX_OPERAND_LEN + 1]; /* The destination operand (or the symbol of .entry/.extern), or an empty string */
+    addressing_mode src_mode; /* The addressing mode of the source operand */
+    addressing_mode dest_mode; /* The addressing mode of the destination operand */
+    int src_value; /* The number of an immediate or register source operand */
+    int dest_value; /* The number of an immediate or register destination operand */
+    unsigned int address; /* The offset of the statement in the code or data segment */
+    int word_count; /* The number of words the statement occupies in its segment */
+    int fixup_start; /* The index of the first expression fixup of the statement */
+    int fixup_count; /* The number of expression fixups of the statement */
+    boolean is_removed; /* Indicates if the statement was removed by an optimization pass */
+    boolean is_referenced; /* Indicates if the statement can be reached or referenced by the program */
+    Stmtptr alias; /* The data statement whose words a removed data statement shares, or NULL */
+    Stmtptr next; /* Pointer to the next statement in the statement list */
+};
+
+static char pending_label[MAX_SYMBOL_LEN + 1]; /* The label of the next emitted statement, or an empty string */
+static boolean was_build_error; /* Indicates if any emitted statement was invalid */
+
+/**
+ * Starts building a new program, resetting the counters and the tables.
+ *
+ * @remarks The function uses the same global variables as the first pass ('ic', 'dc', 'line_num', 'symbol_table'
+ *          and 'stmt_table'). The line number of a built program counts the emitted statements.
+ */
+void begin_program(void) {
+    ic = 0;
+    dc = 0;
+    line_num = 1;
+    symbol_table = NULL;
+    ext_table = NULL;
+    stmt_table = NULL;
+    is_entry_exists = FALSE;
+    is_extern_exists = FALSE;
+
+    pending_label[0] = '\0';
+    was_build_error = FALSE;
+}
+
+/**
+ * Sets the label of the next emitted instruction or data statement.
+ *
+ * @param name The name of the label (without a colon).
+ *
+ * @return TRUE if the label is valid, FALSE otherwise.
+ */
+boolean emit_label(char *name) {
+    /* A label that was not followed by a statement is an error, just like a line with only a symbol */
+    if (pending_label[0] != '\0') {
+        print_error(SYMBOL_ONLY);
+        pending_label[0] = '\0';
+        was_build_error = TRUE;
+    }
+
+    if (!is_symbol(name, FALSE)) {
+        was_build_error = TRUE;
+        return FALSE;
+    }
+
+    strcpy(pending_label, name);
+
+    return TRUE;
+}
+
+/**
+ * Adds the pending label (if any) to the symbol table, pointing at the current statement.
+ *
+ * @param type              The type of the statement the label belongs to (instruction, directive).
+ * @param address           The offset of the statement in its segment.
+ * @param current_symbol    Receives the added symbol, or NULL if there is no pending label.
+ *
+ * @return TRUE if there is no pending label or it was added, FALSE if the label already exists.
+ */
+boolean add_pending_label(statement_type type, unsigned int address, Symbolptr *current_symbol) {
+    *current_symbol = NULL;
+
+    if (pending_label[0] == '\0') {
+        return TRUE;
+    }
+
+    *current_symbol = add_symbol_to_list(&symbol_table, pending_label, address, FALSE);
+    if (*current_symbol == NULL) {
+        return FALSE;
+    }
+    (*current_symbol)->type = type;
+
+    return TRUE;
+}
+
+/**
+ * Records a built statement together with its label, or drops the label if the statement was invalid.
+ *
+ * @param stmt              The statement to record.
+ * @param current_symbol    The symbol defined by the statement, or NULL.
+ * @param is_valid          Indicates if the statement passed validation.
+ *
+ * @return The value of 'is_valid'.
+ */
+boolean record_stmt(Stmtptr stmt, Symbolptr current_symbol, boolean is_valid) {
+    if (is_valid) {
+        if (current_symbol != NULL) {
+            strcpy(stmt->label, current_symbol->name);
+        }
+        add_stmt_to_list(&stmt_table, stmt);
+    } else {
+        if (current_symbol != NULL) {
+            delete_symbol(&symbol_table, current_symbol->name);
+        }
+        was_build_error = TRUE;
+    }
+
+    pending_label[0] = '\0';
+    line_num++;
+
+    return is_valid;
+}
+
+/**
+ * Emits an instruction.
+ *
+ * @param op_type           The opcode of the instruction.
+ * @param first_operand     The source operand, or the destination operand if there is a single operand (NULL if none).
+ * @param second_operand    The destination operand if there are two operands (NULL otherwise).
+ *
+ * @return TRUE if the instruction is valid, FALSE otherwise.
+ *
+ * @remarks The operands are written exactly as in the source language (e.g. "@r3", "-5", "LOOP").
+ */
+boolean emit_op(opcode op_type, char *first_operand, char *second_operand) {
+    Stmt current_stmt;
+    Symbolptr current_symbol = NULL;
+    boolean is_valid = FALSE;
+
+    init_stmt(&current_stmt, INSTRUCTION);
+    current_stmt.address = ic;
+
+    if (op_type == NONE_OP) {
+        print_error(UNDEFINED_OP_DIR);
+    } else if (first_operand == NULL && second_operand != NULL) {
+        print_error(OP_MISSING_OPERAND);
+    } else if (add_pending_label(INSTRUCTION, ic, &current_symbol)) {
+        is_valid = add_operation(op_type, first_operand, second_operand, &current_stmt);
+    }
+
+    return record_stmt(&current_stmt, current_symbol, is_valid);
+}
+
+/**
+ * Emits a data directive.
+ *
+ * @param values    The numbers to append to the data segment.
+ * @param count     The number of values.
+ *
+ * @return TRUE if the directive is valid, FALSE otherwise.
+ */
+boolean emit_data(int *values, int count) {
+    Stmt current_stmt;
+    Symbolptr current_symbol = NULL;
+    boolean is_valid = FALSE;
+    int i;
+
+    init_stmt(&current_stmt, DIRECTIVE);
+    current_stmt.dir = DATA;
+    current_stmt.address = dc;
+
+    if (values == NULL || count < 1) {
+        print_error(DIR_MISSING_PARAMS);
+    } else if (add_pending_label(DIRECTIVE, dc, &current_symbol)) {
+        for (i = 0; i < count; i++) {
+            append_number_to_data(values[i]);
+        }
+        current_stmt.word_count = count;
+        is_valid = TRUE;
+    }
+
+    return record_stmt(&current_stmt, current_symbol, is_valid);
+}
+
+/**
+ * Emits a string directive.
+ *
+ * @param str The characters of the string (without the enclosing double quotes).
+ *
+ * @return TRUE if the directive is valid, FALSE otherwise.
+ */
+boolean emit_string(char *str) {
+    Stmt current_stmt;
+    Symbolptr current_symbol = NULL;
+    boolean is_valid = FALSE;
+
+    init_stmt(&current_stmt, DIRECTIVE);
+    current_stmt.dir = STRING;
+    current_stmt.address = dc;
+
+    /* A double quote cannot appear inside a string literal of the source language either */
+    if (str == NULL || strchr(str, '\"') != NULL) {
+        print_error(STRING_NOT_STR);
+    } else if (add_pending_label(DIRECTIVE, dc, &current_symbol)) {
+        while (*str != '\0') {
+            append_character_to_data(*str++);
+        }
+        append_character_to_data('\0');
+        current_stmt.word_count = dc - current_stmt.address;
+        is_valid = TRUE;
+    }
+
+    return record_stmt(&current_stmt, current_symbol, is_valid);
+}
+
+/**
+ * Emits an entry or extern directive, validated by the same functions as the text front end.
+ *
+ * @param dir_type  The type of the directive (ENTRY, EXTERN).
+ * @param name      The symbol named by the directive.
+ *
+ * @return TRUE if the directive is valid, FALSE otherwise.
+ */
+boolean emit_symbol_dir(directive dir_type, char *name) {
+    Stmt current_stmt;
+    boolean is_valid = FALSE;
+
+    /* A label before an entry or extern directive is ignored, as in the source language */
+    pending_label[0] = '\0';
+
+    init_stmt(&current_stmt, DIRECTIVE);
+    current_stmt.address = dc;
+
+    if (name == NULL) {
+        print_error(DIR_MISSING_PARAMS);
+    } else if (strlen(name) > MAX_OPERAND_LEN) {
+        print_error(SYMBOL_TOO_LONG);
+    } else {
+        is_valid = process_directive(dir_type, name, &current_stmt);
+    }
+
+    return record_stmt(&current_stmt, NULL, is_valid);
+}
+
+/**
+ * Emits an extern directive.
+ *
+ * @param name The name of the external symbol.
+ *
+ * @return TRUE if the directive is valid, FALSE otherwise.
+ */
+boolean declare_extern(char *name) {
+    return emit_symbol_dir(EXTERN, name);
+}
+
+/**
+ * Emits an entry directive.
+ *
+ * @param name The name of the entry symbol.
+ *
+ * @return TRUE if the directive is valid, FALSE otherwise.
+ */
+boolean declare_entry(char *name) {
+    return emit_symbol_dir(ENTRY, name);
+}
+
+/**
+ * Finishes building the program and assembles it into the output files.
+ *
+ * @param name The base name of the output files.
+ *
+ * @return True if there were errors while building or assembling the program, False otherwise.
+ */
+boolean end_program(char *name) {
+    /* A trailing label without a statement is an error */
+    if (pending_label[0] != '\0') {
+        print_error(SYMBOL_ONLY);
+        pending_label[0] = '\0';
+        was_build_error = TRUE;
+    }
+
+    /* Update the addresses of symbols in the symbol table, as at the end of the first pass */
+    update_symbol_addr(symbol_table, MEM_START, INSTRUCTION);
+    update_symbol_addr(symbol_table, ic + MEM_START, DIRECTIVE);
+
+    if (was_build_error) {
+        print_error(FIRST_PASS_FAILED);
+    }
+
+    return finish_assembly(name, !was_build_error);
+}
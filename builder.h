@@ -0,0 +1,27 @@
+/**
+ * This header file declares the builder API of the assembler. The builder API lets a program generator emit
+ * statements directly into the statement list and the symbol table, skipping the pre-processor and the parsing of
+ * the first pass, while sharing the validation, the optional optimization passes, the second pass and the output
+ * writers with the text front end.
+ */
+
+#ifndef ASM_BUILDER_H
+#define ASM_BUILDER_H
+
+#include "utils.h"
+#include "symbol_structs.h"
+#include "statement_structs.h"
+
+void begin_program(void);
+boolean emit_label(char *);
+boolean add_pending_label(statement_type, unsigned int, Symbolptr *);
+boolean record_stmt(Stmtptr, Symbolptr, boolean);
+boolean emit_op(opcode, char *, char *);
+boolean emit_data(int *, int);
+boolean emit_string(char *);
+boolean emit_symbol_dir(directive, char *);
+boolean declare_extern(char *);
+boolean declare_entry(char *);
+boolean end_program(char *);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,999 @@
+/**
+ * This file contains the implementation of the build coordinator. Each worker is a child process that assembles in a
+ * scratch directory of its own and talks to the coordinator over one end of a socket pair. The coordinator hands the
+ * largest pending source file to each idle worker, so the long shards start first and the short ones fill the gaps, and
+ * it writes the files each worker sends back next to the source file. A shard whose worker dies, breaks the protocol or
+ * passes the deadline of the shard is sent to a restarted worker, up to MAX_SHARD_ATTEMPTS times. The output of the
+ * shards is printed in the order of the files on the command line, as if they were assembled one after the other.
+ *
+ * Every message is a sequence of numbers and byte strings. A number is 4 bytes, most significant first, and a byte
+ * string is its length (at most MAX_TRANSFER_LEN) followed by its bytes, or the length -1 for a missing string. A shard
+ * is sent as its index, its name and its source; a result is sent as the shard index, the number of parts and the
+ * parts, each of them a file type (or OUTPUT_PART for the output of the assembler) and its bytes. Closing the socket
+ * stops the worker.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include "coordinator.h"
+#include "utils.h"
+#include "globals.h"
+#include "assembler.h"
+#include "build_cache.h"
+
+/* Definition of a shard: a source file to assemble in a worker */
+struct shard {
+    char *name; /* The name of the source file (without an extension), as given on the command line */
+    long size; /* The size of the source file in bytes, or -1 if it cannot be opened */
+    long line_count; /* The number of lines of the source file */
+    long estimated_memory; /* The memory the assembly of the shard is estimated to take, in bytes */
+    long admitted_memory; /* The memory the shard holds in the budget while a worker assembles it, in bytes */
+    shard_state state; /* The state of the shard */
+    int attempts; /* The number of workers the shard was sent to */
+    char *output; /* The output of the assembler on the shard */
+    long output_len; /* The number of characters of the output */
+};
+
+/* Definition of a worker process */
+struct worker {
+    pid_t pid; /* The process ID of the worker, or -1 if it is not running */
+    int fd; /* The coordinator end of the socket connected to the worker */
+    int shard; /* The index of the shard the worker is assembling, or -1 if it is idle */
+    time_t deadline; /* The time by which the worker must send the result of its shard */
+};
+
+static Worker workers[MAX_WORKERS]; /* The pool of worker processes */
+static int pool_size; /* The number of workers in the pool */
+static long admitted_memory_total; /* The memory held in the budget by the shards the workers are assembling */
+static double memory_factor = 1.0; /* The largest ratio seen between the measured and the estimated memory of a shard */
+static long timeout_seconds = DEFAULT_SHARD_TIMEOUT; /* The seconds a worker may take on a shard */
+
+/* The files a worker sends back after assembling a shard, besides the output of the assembler */
+static const file_type result_files[] = {FILE_MACRO, FILE_OBJECT, FILE_ENTRIES, FILE_EXTERNALS, FILE_LISTING,
+                                         FILE_FOLDED};
+
+#define RESULT_FILE_COUNT ((int)(sizeof(result_files) / sizeof(result_files[0])))
+
+/**
+ * Writes a buffer to a socket, retrying the partial and interrupted writes.
+ *
+ * @param fd        The socket.
+ * @param buffer    The buffer.
+ * @param length    The number of bytes to write.
+ *
+ * @return TRUE if all the bytes were written, FALSE otherwise.
+ */
+boolean write_all(int fd, char *buffer, long length) {
+    ssize_t written;
+
+    while (length > 0) {
+        written = write(fd, buffer, (size_t)length);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return FALSE;
+        }
+        buffer += written;
+        length -= written;
+    }
+
+    return TRUE;
+}
+
+/**
+ * Reads a buffer from a socket, retrying the partial and interrupted reads.
+ *
+ * @param fd        The socket.
+ * @param buffer    The buffer.
+ * @param length    The number of bytes to read.
+ *
+ * @return TRUE if all the bytes were read, FALSE if the socket failed or was closed first.
+ */
+boolean read_all(int fd, char *buffer, long length) {
+    ssize_t count;
+
+    while (length > 0) {
+        count = read(fd, buffer, (size_t)length);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return FALSE;
+        }
+        buffer += count;
+        length -= count;
+    }
+
+    return TRUE;
+}
+
+/**
+ * Sends a number as 4 bytes, most significant first.
+ *
+ * @param fd        The socket.
+ * @param number    The number, between -MAX_NUMBER - 1 and MAX_NUMBER.
+ *
+ * @return TRUE if the number was sent, FALSE otherwise (or if it does not fit in 32 bits).
+ */
+boolean send_number(int fd, long number) {
+    unsigned long value = (unsigned long)number;
+    char bytes[4];
+
+    if (number > MAX_NUMBER || number < -MAX_NUMBER - 1) {
+        return FALSE;
+    }
+
+    bytes[0] = (char)((value >> 24) & 0xFF);
+    bytes[1] = (char)((value >> 16) & 0xFF);
+    bytes[2] = (char)((value >> 8) & 0xFF);
+    bytes[3] = (char)(value & 0xFF);
+
+    return write_all(fd, bytes, 4);
+}
+
+/**
+ * Receives a number sent by send_number.
+ *
+ * @param fd        The socket.
+ * @param number    Set to the number.
+ *
+ * @return TRUE if the number was received, FALSE otherwise.
+ */
+boolean receive_number(int fd, long *number) {
+    unsigned char bytes[4];
+    unsigned long value;
+
+    if (!read_all(fd, (char *)bytes, 4)) {
+        return FALSE;
+    }
+
+    value = ((unsigned long)bytes[0] << 24) | ((unsigned long)bytes[1] << 16) | ((unsigned long)bytes[2] << 8) |
+            (unsigned long)bytes[3];
+
+    /* The number is a 32-bit two's complement number */
+    *number = value >= 0x80000000UL ? -(long)(0xFFFFFFFFUL - value) - 1 : (long)value;
+
+    return TRUE;
+}
+
+/**
+ * Sends a byte string: its length and its bytes.
+ *
+ * @param fd        The socket.
+ * @param bytes     The bytes, or NULL for a missing string.
+ * @param length    The number of bytes (ignored for a missing string).
+ *
+ * @return TRUE if the string was sent, FALSE otherwise.
+ */
+boolean send_bytes(int fd, char *bytes, long length) {
+    if (bytes == NULL) {
+        return send_number(fd, -1);
+    }
+
+    /* A longer string would not fit the length field, or would be refused by the receiver */
+    if (length > MAX_TRANSFER_LEN) {
+        return FALSE;
+    }
+
+    return send_number(fd, length) && write_all(fd, bytes, length);
+}
+
+/**
+ * Receives a byte string sent by send_bytes.
+ *
+ * @param fd            The socket.
+ * @param max_length    The largest number of bytes the string may have.
+ * @param length        Set to the number of bytes, or -1 for a missing string.
+ *
+ * @return A dynamically allocated buffer holding the bytes followed by a null character, or NULL if the string is
+ *         missing or was not received (the length is then -2).
+ *
+ * @remarks A string longer than the maximum, or one that does not fit in memory, is not received, so a peer cannot
+ *          stop the receiving process by sending a large length.
+ */
+char *receive_bytes(int fd, long max_length, long *length) {
+    char *bytes;
+
+    if (!receive_number(fd, length) || *length < -1 || *length > max_length || *length > MAX_TRANSFER_LEN) {
+        *length = -2;
+        return NULL;
+    }
+
+    if (*length == -1) {
+        return NULL;
+    }
+
+    bytes = (char *)malloc((*length + 1) * sizeof(char));
+    if (bytes == NULL) {
+        print_error(MEM_ALLOC_FAILED);
+        *length = -2;
+        return NULL;
+    }
+
+    if (!read_all(fd, bytes, *length)) {
+        free(bytes);
+        *length = -2;
+        return NULL;
+    }
+    bytes[*length] = '\0';
+
+    return bytes;
+}
+
+/**
+ * Reads a whole file into memory.
+ *
+ * @param filename  The name of the file.
+ * @param length    Set to the number of bytes of the file.
+ *
+ * @return A dynamically allocated buffer holding the bytes of the file, or NULL if it cannot be read.
+ */
+char *read_whole_file(char *filename, long *length) {
+    FILE *fd = fopen(filename, "rb");
+    char *bytes;
+
+    if (fd == NULL) {
+        return NULL;
+    }
+
+    if (fseek(fd, 0, SEEK_END) != 0 || (*length = ftell(fd)) < 0 || fseek(fd, 0, SEEK_SET) != 0) {
+        fclose(fd);
+        return NULL;
+    }
+
+    bytes = (char *)malloc((*length + 1) * sizeof(char));
+    if (bytes == NULL) {
+        print_error(MEM_ALLOC_FAILED);
+        exit(1);
+    }
+
+    if (fread(bytes, 1, (size_t)*length, fd) != (size_t)*length) {
+        free(bytes);
+        fclose(fd);
+        return NULL;
+    }
+
+    fclose(fd);
+
+    return bytes;
+}
+
+/**
+ * Writes a whole file from memory.
+ *
+ * @param filename  The name of the file.
+ * @param bytes     The bytes of the file.
+ * @param length    The number of bytes.
+ *
+ * @return TRUE if the file was written, FALSE otherwise.
+ */
+boolean write_whole_file(char *filename, char *bytes, long length) {
+    FILE *fd = fopen(filename, "wb");
+    boolean success;
+
+    if (fd == NULL) {
+        return FALSE;
+    }
+
+    success = fwrite(bytes, 1, (size_t)length, fd) == (size_t)length;
+
+    return fclose(fd) == 0 && success;
+}
+
+/**
+ * Sends the result of the assembly of a source file: the number of parts, the output of the assembler and the files
+ * the assembler wrote.
+ *
+ * @param fd            The socket.
+ * @param name          The name of the source file (without an extension).
+ * @param output        The output of the assembler.
+ * @param output_len    The number of characters of the output.
+ *
+ * @return TRUE if the result was sent, FALSE otherwise.
+ */
+boolean send_result_files(int fd, char *name, char *output, long output_len) {
+    char *parts[RESULT_FILE_COUNT];
+    long part_lengths[RESULT_FILE_COUNT];
+    char *modified_filename;
+    boolean success;
+    int part_count = 1;
+    int i;
+
+    for (i = 0; i < RESULT_FILE_COUNT; i++) {
+        modified_filename = generate_new_filename(name, result_files[i]);
+        parts[i] = read_whole_file(modified_filename, &part_lengths[i]);
+        free(modified_filename);
+
+        if (parts[i] != NULL) {
+            part_count++;
+        }
+    }
+
+    success = send_number(fd, part_count) && send_number(fd, OUTPUT_PART) && send_bytes(fd, output, output_len);
+    for (i = 0; i < RESULT_FILE_COUNT; i++) {
+        if (parts[i] != NULL) {
+            success = success && send_number(fd, result_files[i]) && send_bytes(fd, parts[i], part_lengths[i]);
+            free(parts[i]);
+        }
+    }
+
+    return success;
+}
+
+/**
+ * Receives the result of the assembly of a source file sent by send_result_files, and writes the files next to the
+ * source file.
+ *
+ * @param fd            The socket.
+ * @param name          The name of the source file (without an extension).
+ * @param max_length    The largest number of bytes each file (and the output) may have.
+ * @param output        Set to a dynamically allocated buffer holding the output of the assembler.
+ * @param output_len    Set to the number of characters of the output.
+ *
+ * @return TRUE if the result was received, FALSE otherwise.
+ */
+boolean receive_result_files(int fd, char *name, long max_length, char **output, long *output_len) {
+    char *modified_filename;
+    char *bytes;
+    long part_count;
+    long part_type;
+    long length;
+    int i;
+
+    *output = NULL;
+
+    if (!receive_number(fd, &part_count)) {
+        return FALSE;
+    }
+
+    for (i = 0; i < part_count; i++) {
+        if (!receive_number(fd, &part_type) || part_type < OUTPUT_PART || part_type > FILE_FOLDED ||
+            part_type == FILE_SOURCE) {
+            free(*output);
+            *output = NULL;
+            return FALSE;
+        }
+
+        bytes = receive_bytes(fd, max_length, &length);
+        if (bytes == NULL) {
+            free(*output);
+            *output = NULL;
+            return FALSE;
+        }
+
+        if (part_type == OUTPUT_PART) {
+            free(*output);
+            *output = bytes;
+            *output_len = length;
+        } else {
+            modified_filename = generate_new_filename(name, (file_type)part_type);
+            if (!write_whole_file(modified_filename, bytes, length)) {
+                print_error(CANNOT_OPEN_FILE);
+            }
+            free(modified_filename);
+            free(bytes);
+        }
+    }
+
+    return *output != NULL;
+}
+
+/**
+ * Removes the files the assembler writes for a source file.
+ *
+ * @param name The name of the source file (without an extension).
+ */
+void remove_result_files(char *name) {
+    char *modified_filename;
+    int i;
+
+    for (i = 0; i < RESULT_FILE_COUNT; i++) {
+        modified_filename = generate_new_filename(name, result_files[i]);
+        remove(modified_filename);
+        free(modified_filename);
+    }
+}
+
+/**
+ * Assembles a shard in the scratch directory of the worker, sends back the output of the assembler and the files it
+ * wrote, and removes the files.
+ *
+ * @param fd            The worker end of the socket.
+ * @param index         The index of the shard.
+ * @param name          The name of the shard.
+ * @param source        The bytes of the source file, or NULL if the coordinator could not read it.
+ * @param source_len    The number of bytes of the source file.
+ *
+ * @return TRUE if the result was sent, FALSE otherwise.
+ */
+boolean serve_shard(int fd, long index, char *name, char *source, long source_len) {
+    char *modified_filename_source = generate_new_filename(name, FILE_SOURCE);
+    char *output;
+    long output_len = 0;
+    long peak_memory = measure_peak_memory();
+    boolean success;
+
+    /* A missing source is left missing, so the assembler reports it as it would without the coordinator */
+    if (source != NULL) {
+        write_whole_file(modified_filename_source, source, source_len);
+    }
+
+    /* Collect the output of the assembler in a file of the scratch directory */
+    if (freopen(SHARD_OUTPUT_FILE, "w", stdout) == NULL) {
+        free(modified_filename_source);
+        return FALSE;
+    }
+
+    if (cache_path != NULL) {
+        assemble_cached(name);
+    } else {
+        assemble_source(name);
+    }
+    fflush(stdout);
+
+    output = read_whole_file(SHARD_OUTPUT_FILE, &output_len);
+    /* The growth of the peak memory of the worker lets the coordinator correct its estimates */
+    success = output != NULL && send_number(fd, index) && send_number(fd, measure_peak_memory() - peak_memory) &&
+              send_result_files(fd, name, output, output_len);
+    free(output);
+
+    /* Leave the scratch directory empty for the next shard */
+    remove_result_files(name);
+    remove(modified_filename_source);
+    free(modified_filename_source);
+
+    return success;
+}
+
+/**
+ * Builds the name of the scratch directory of a worker.
+ *
+ * @param pid The process ID of the worker.
+ *
+ * @return A dynamically allocated string holding the name of the directory, in the temporary directory.
+ */
+char *get_scratch_directory(long pid) {
+    char *temp_dir = getenv("TMPDIR");
+    char *directory;
+
+    if (temp_dir == NULL || *temp_dir == '\0') {
+        temp_dir = "/tmp";
+    }
+
+    directory = (char *)malloc((strlen(temp_dir) + MAX_SCRATCH_SUFFIX_LEN) * sizeof(char));
+    if (directory == NULL) {
+        print_error(MEM_ALLOC_FAILED);
+        exit(1);
+    }
+    sprintf(directory, "%s/asm-worker-%ld", temp_dir, pid);
+
+    return directory;
+}
+
+/**
+ * Removes the scratch directory of a worker that was killed while assembling a shard, with the files of the shard.
+ *
+ * @param pid   The process ID of the worker.
+ * @param name  The name of the shard in the scratch directory.
+ */
+void remove_scratch_directory(long pid, char *name) {
+    char *directory = get_scratch_directory(pid);
+    char *path = (char *)malloc((strlen(directory) + strlen(name) + strlen(SHARD_OUTPUT_FILE) + 2) * sizeof(char));
+    char *modified_filename;
+    int type;
+
+    if (path == NULL) {
+        print_error(MEM_ALLOC_FAILED);
+        exit(1);
+    }
+
+    sprintf(path, "%s/%s", directory, SHARD_OUTPUT_FILE);
+    remove(path);
+
+    sprintf(path, "%s/%s", directory, name);
+    for (type = FILE_SOURCE; type <= FILE_FOLDED; type++) {
+        modified_filename = generate_new_filename(path, (file_type)type);
+        remove(modified_filename);
+        free(modified_filename);
+    }
+
+    rmdir(directory);
+    free(path);
+    free(directory);
+}
+
+/**
+ * Runs a worker: creates its scratch directory and assembles the shards it receives until the coordinator closes
+ * the socket.
+ *
+ * @param fd The worker end of the socket.
+ */
+void serve_worker(int fd) {
+    char *directory = get_scratch_directory((long)getpid());
+    char *name;
+    char *source;
+    long name_len;
+    long source_len;
+    long index;
+
+    if (mkdir(directory, 0700) != 0 || chdir(directory) != 0) {
+        free(directory);
+        return;
+    }
+
+    while (receive_number(fd, &index)) {
+        name = receive_bytes(fd, MAX_TRANSFER_LEN, &name_len);
+        source = receive_bytes(fd, MAX_TRANSFER_LEN, &source_len);
+
+        if (name == NULL || source_len == -2 || !serve_shard(fd, index, name, source, source_len)) {
+            free(name);
+            free(source);
+            break;
+        }
+
+        free(name);
+        free(source);
+    }
+
+    /* The scratch directory is removed from its parent, which works for a relative temporary directory too */
+    remove(SHARD_OUTPUT_FILE);
+    if (chdir("..") == 0) {
+        rmdir(strrchr(directory, '/') + 1);
+    }
+    free(directory);
+}
+
+/**
+ * Starts a worker process connected to the coordinator by a socket pair.
+ *
+ * @param worker The worker.
+ *
+ * @return TRUE if the worker was started, FALSE otherwise.
+ */
+boolean start_worker(Workerptr worker) {
+    struct timeval timeout;
+    int fds[2];
+    int i;
+
+    worker->pid = -1;
+    worker->fd = -1;
+    worker->shard = -1;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        return FALSE;
+    }
+
+    /* Flush the output first, so the worker does not print it again */
+    fflush(stdout);
+
+    worker->pid = fork();
+    if (worker->pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return FALSE;
+    }
+
+    if (worker->pid == 0) {
+        /* Close the sockets of the other workers, which would otherwise never see the coordinator close them */
+        for (i = 0; i < pool_size; i++) {
+            if (workers[i].fd != -1 && &workers[i] != worker) {
+                close(workers[i].fd);
+            }
+        }
+        close(fds[0]);
+
+        serve_worker(fds[1]);
+        close(fds[1]);
+        _exit(0);
+    }
+
+    close(fds[1]);
+    worker->fd = fds[0];
+
+    /* A worker that stops reading or writing in the middle of a message cannot block the coordinator either */
+    timeout.tv_sec = timeout_seconds;
+    timeout.tv_usec = 0;
+    setsockopt(worker->fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(worker->fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    return TRUE;
+}
+
+/**
+ * Stops a worker process: closes its socket, which ends its loop, and waits for it.
+ *
+ * @param worker    The worker.
+ * @param is_failed Indicates if the worker failed, in which case it is killed instead of left to finish.
+ */
+void stop_worker(Workerptr worker, boolean is_failed) {
+    if (worker->fd != -1) {
+        close(worker->fd);
+        worker->fd = -1;
+    }
+
+    if (worker->pid > 0) {
+        if (is_failed) {
+            kill(worker->pid, SIGKILL);
+        }
+        while (waitpid(worker->pid, NULL, 0) < 0 && errno == EINTR) {
+        }
+        worker->pid = -1;
+    }
+
+    worker->shard = -1;
+}
+
+/**
+ * Finds the last component of the name of a source file, which names the file in the scratch directory of a worker.
+ *
+ * @param name The name of the source file (without an extension).
+ *
+ * @return A pointer to the last component of the name.
+ */
+char *get_base_name(char *name) {
+    char *separator = strrchr(name, '/');
+
+    return separator == NULL ? name : separator + 1;
+}
+
+/**
+ * Sends a shard to an idle worker.
+ *
+ * @param worker    The worker.
+ * @param shard     The shard.
+ * @param index     The index of the shard.
+ *
+ * @return TRUE if the shard was sent, FALSE otherwise.
+ */
+boolean assign_shard(Workerptr worker, Shardptr shard, int index) {
+    char *modified_filename_source = generate_new_filename(shard->name, FILE_SOURCE);
+    char *base_name = get_base_name(shard->name);
+    char *source;
+    long source_len = 0;
+    boolean success;
+
+    source = read_whole_file(modified_filename_source, &source_len);
+    free(modified_filename_source);
+
+    success = send_number(worker->fd, index) && send_bytes(worker->fd, base_name, (long)strlen(base_name)) &&
+              send_bytes(worker->fd, source, source_len);
+    free(source);
+
+    shard->state = RUNNING_SHARD;
+    shard->attempts++;
+    worker->deadline = time(NULL) + timeout_seconds;
+    shard->admitted_memory = (long)(shard->estimated_memory * memory_factor);
+    admitted_memory_total += shard->admitted_memory;
+    worker->shard = index;
+
+    return success;
+}
+
+/**
+ * Receives the result of a shard from a worker, keeps the output of the assembler and writes the files next to the
+ * source file.
+ *
+ * @param worker    The worker.
+ * @param shard     The shard the worker is assembling.
+ *
+ * @return TRUE if the result was received, FALSE if the worker failed.
+ */
+boolean receive_result(Workerptr worker, Shardptr shard) {
+    long index;
+    long memory_growth;
+
+    if (!receive_number(worker->fd, &index) || index != worker->shard || !receive_number(worker->fd, &memory_growth)) {
+        return FALSE;
+    }
+
+    /* A shard that took more memory than estimated raises the estimates of the shards admitted after it */
+    if (memory_growth * 1024.0 > shard->estimated_memory * memory_factor) {
+        memory_factor = memory_growth * 1024.0 / shard->estimated_memory;
+    }
+
+    free(shard->output);
+    if (!receive_result_files(worker->fd, shard->name, MAX_TRANSFER_LEN, &shard->output, &shard->output_len)) {
+        return FALSE;
+    }
+
+    shard->state = DONE_SHARD;
+    worker->shard = -1;
+    admitted_memory_total -= shard->admitted_memory;
+    shard->admitted_memory = 0;
+
+    return TRUE;
+}
+
+/**
+ * Compares two shards by the sizes of their source files, for sorting the shards largest first.
+ *
+ * @param first     A pointer to the first shard.
+ * @param second    A pointer to the second shard.
+ *
+ * @return A negative number if the first shard is larger, a positive number if it is smaller, and the order of the
+ *         shards on the command line if they are of the same size.
+ */
+int compare_shards(const void *first, const void *second) {
+    const Shard *first_shard = *(const Shard *const *)first;
+    const Shard *second_shard = *(const Shard *const *)second;
+
+    if (first_shard->size != second_shard->size) {
+        return first_shard->size > second_shard->size ? -1 : 1;
+    }
+
+    return first_shard < second_shard ? -1 : first_shard > second_shard ? 1 : 0;
+}
+
+/**
+ * Measures the size and the number of lines of the source file of a shard, and estimates the memory its assembly
+ * takes: a fixed part for the tables and buffers of a program, a part for the copies of the source text (the kept
+ * lines, the extended source and the macro bodies), and a part for each line (its statement, kept line and symbol).
+ *
+ * @param shard The shard.
+ */
+void measure_source(Shardptr shard) {
+    char *modified_filename_source = generate_new_filename(shard->name, FILE_SOURCE);
+    FILE *source_fd = fopen(modified_filename_source, "rb");
+    int c;
+
+    free(modified_filename_source);
+
+    shard->size = -1;
+    shard->line_count = 0;
+
+    if (source_fd != NULL) {
+        shard->size = 0;
+        while ((c = getc(source_fd)) != EOF) {
+            shard->size++;
+            if (c == '\n') {
+                shard->line_count++;
+            }
+        }
+        fclose(source_fd);
+    }
+
+    shard->estimated_memory = SHARD_BASE_MEMORY + (shard->size > 0 ? shard->size * MEMORY_PER_SOURCE_BYTE : 0) +
+                              shard->line_count * MEMORY_PER_LINE;
+}
+
+/**
+ * Measures the peak resident memory of the process.
+ *
+ * @return The peak resident memory in kilobytes, or 0 if it cannot be measured.
+ *
+ * @remarks The peak never decreases, so its growth over a shard only counts the memory beyond the earlier shards.
+ */
+long measure_peak_memory(void) {
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+
+    return (long)usage.ru_maxrss;
+}
+
+/**
+ * Finds the largest pending shard whose memory fits the budget along with the shards the workers are assembling.
+ *
+ * @param order         The shards, largest first.
+ * @param shard_count   The number of shards.
+ *
+ * @return The position of the shard in the order, or -1 if no pending shard fits.
+ *
+ * @remarks When no shard is running the largest pending shard is admitted whatever its estimate, so a file larger
+ *          than the budget is assembled alone instead of never.
+ */
+int find_admissible_shard(Shardptr *order, int shard_count) {
+    int i;
+
+    for (i = 0; i < shard_count; i++) {
+        if (order[i]->state == PENDING_SHARD &&
+            (memory_budget == 0 || admitted_memory_total == 0 ||
+             admitted_memory_total + (long)(order[i]->estimated_memory * memory_factor) <= memory_budget)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * Handles a failed shard: stops its worker and removes its scratch directory, starts a new one in its place, and sends the shard again later unless it
+ * failed MAX_SHARD_ATTEMPTS times.
+ *
+ * @param worker    The worker that failed.
+ * @param shard     The shard of the worker.
+ *
+ * @return TRUE if the shard has no more attempts, FALSE if it is pending again.
+ */
+boolean fail_shard(Workerptr worker, Shardptr shard) {
+    long pid = (long)worker->pid;
+
+    stop_worker(worker, TRUE);
+    if (pid > 0) {
+        remove_scratch_directory(pid, get_base_name(shard->name));
+    }
+    start_worker(worker);
+
+    shard->state = shard->attempts >= MAX_SHARD_ATTEMPTS ? FAILED_SHARD : PENDING_SHARD;
+    admitted_memory_total -= shard->admitted_memory;
+    shard->admitted_memory = 0;
+
+    return shard->state == FAILED_SHARD;
+}
+
+/**
+ * Fails the shards whose workers passed their deadline, stopping the workers.
+ *
+ * @param shards    The shards.
+ * @param remaining The number of shards that are not done or failed, decreased by the shards that failed for good.
+ */
+void fail_overdue_shards(Shardptr shards, int *remaining) {
+    time_t now = time(NULL);
+    int i;
+
+    for (i = 0; i < pool_size; i++) {
+        if (workers[i].fd != -1 && workers[i].shard != -1 && now >= workers[i].deadline &&
+            fail_shard(&workers[i], &shards[workers[i].shard])) {
+            (*remaining)--;
+        }
+    }
+}
+
+/**
+ * Assembles the source files in the pool of worker processes, and prints the output of each file in the order of the
+ * file names.
+ *
+ * @param file_count    The number of file names.
+ * @param files         The names of the source files (from the command line and the manifest file).
+ */
+void run_coordinator(int file_count, char *files[]) {
+    Shardptr shards;
+    Shardptr *order; /* The shards, largest first */
+    fd_set ready_fds;
+    struct timeval timeout;
+    time_t earliest_deadline = 0;
+    time_t now;
+    int ready_count;
+    int shard_count = 0;
+    int remaining;
+    int max_fd;
+    int i;
+    int j;
+
+    shards = (Shardptr)malloc(file_count * sizeof(Shard));
+    order = (Shardptr *)malloc(file_count * sizeof(Shardptr));
+    if (shards == NULL || order == NULL) {
+        print_error(MEM_ALLOC_FAILED);
+        exit(1);
+    }
+
+    for (i = 0; i < file_count; i++) {
+        shards[shard_count].name = files[i];
+        shards[shard_count].state = PENDING_SHARD;
+        shards[shard_count].attempts = 0;
+        shards[shard_count].output = NULL;
+        shards[shard_count].output_len = 0;
+        shards[shard_count].admitted_memory = 0;
+
+        /* The size of the source balances the load (the largest files are sent first) and estimates its memory */
+        measure_source(&shards[shard_count]);
+
+        order[shard_count] = &shards[shard_count];
+        shard_count++;
+    }
+
+    qsort(order, shard_count, sizeof(Shardptr), compare_shards);
+
+    timeout_seconds = shard_timeout > 0 ? shard_timeout : DEFAULT_SHARD_TIMEOUT;
+
+    /* A worker that dies while a shard is sent to it must not stop the coordinator */
+    signal(SIGPIPE, SIG_IGN);
+
+    pool_size = worker_count < shard_count ? worker_count : shard_count;
+    for (i = 0; i < pool_size; i++) {
+        workers[i].fd = -1;
+    }
+    for (i = 0; i < pool_size; i++) {
+        start_worker(&workers[i]);
+    }
+
+    remaining = shard_count;
+    while (remaining > 0) {
+        /* Send the largest pending shards that fit the memory budget to the idle workers */
+        for (i = 0; i < pool_size; i++) {
+            while (workers[i].fd != -1 && workers[i].shard == -1) {
+                j = find_admissible_shard(order, shard_count);
+                if (j == -1) {
+                    break;
+                }
+
+                if (!assign_shard(&workers[i], order[j], (int)(order[j] - shards)) &&
+                    fail_shard(&workers[i], order[j])) {
+                    remaining--;
+                }
+            }
+        }
+
+        /* Wait for the busy workers, until the earliest deadline of their shards */
+        FD_ZERO(&ready_fds);
+        max_fd = -1;
+        for (i = 0; i < pool_size; i++) {
+            if (workers[i].fd != -1 && workers[i].shard != -1) {
+                FD_SET(workers[i].fd, &ready_fds);
+                if (max_fd == -1 || workers[i].deadline < earliest_deadline) {
+                    earliest_deadline = workers[i].deadline;
+                }
+                max_fd = workers[i].fd > max_fd ? workers[i].fd : max_fd;
+            }
+        }
+
+        /* Without a busy worker no worker could be started, and the pending shards fail */
+        if (max_fd == -1) {
+            for (i = 0; i < shard_count; i++) {
+                if (shards[i].state == PENDING_SHARD) {
+                    shards[i].state = FAILED_SHARD;
+                }
+            }
+            break;
+        }
+
+        now = time(NULL);
+        timeout.tv_sec = earliest_deadline > now ? (long)(earliest_deadline - now) : 0;
+        timeout.tv_usec = 0;
+        ready_count = select(max_fd + 1, &ready_fds, NULL, NULL, &timeout);
+        if (ready_count < 0) {
+            continue;
+        }
+        if (ready_count == 0) {
+            FD_ZERO(&ready_fds);
+        }
+
+        for (i = 0; i < pool_size; i++) {
+            if (workers[i].fd != -1 && workers[i].shard != -1 && FD_ISSET(workers[i].fd, &ready_fds)) {
+                Shardptr shard = &shards[workers[i].shard];
+
+                if (receive_result(&workers[i], shard) || fail_shard(&workers[i], shard)) {
+                    remaining--;
+                }
+            }
+        }
+
+        /* A worker that hangs on its shard without exiting is stopped, and the shard retried like a dead worker's */
+        fail_overdue_shards(shards, &remaining);
+    }
+
+    for (i = 0; i < pool_size; i++) {
+        stop_worker(&workers[i], FALSE);
+    }
+
+    /* Print the output of the shards in the order of the file names */
+    for (i = 0; i < shard_count; i++) {
+        if (shards[i].state == DONE_SHARD) {
+            fwrite(shards[i].output, 1, (size_t)shards[i].output_len, stdout);
+        } else {
+            printf("%s: ", shards[i].name);
+            print_error(SHARD_FAILED);
+        }
+        free(shards[i].output);
+    }
+
+    free(shards);
+    free(order);
+}
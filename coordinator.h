@@ -0,0 +1,71 @@
+/**
+ * This header file declares the functions of the build coordinator. The coordinator shards the source files given on
+ * the command line over a pool of worker processes, each connected to it by a stream socket. It ships the bytes of
+ * each source file to a worker and receives the output of the assembler and the bytes of the files it wrote, so the
+ * same protocol can later run over TCP to workers on other nodes.
+ */
+
+#ifndef ASM_COORDINATOR_H
+#define ASM_COORDINATOR_H
+
+#include <limits.h>
+#include "utils.h"
+
+#define MAX_WORKERS 64
+#define MAX_MEMORY_BUDGET_MB (LONG_MAX / (1024L * 1024))
+#define MAX_SHARD_ATTEMPTS 3
+#define DEFAULT_SHARD_TIMEOUT 60
+#define MAX_SHARD_TIMEOUT 86400
+#define MAX_NUMBER 0x7FFFFFFFL
+#define MAX_TRANSFER_LEN (64L * 1024 * 1024)
+#define OUTPUT_PART (-1)
+#define SHARD_OUTPUT_FILE "shard.out"
+#define MAX_SCRATCH_SUFFIX_LEN 32
+#define SHARD_BASE_MEMORY (256L * 1024)
+#define MEMORY_PER_SOURCE_BYTE 4
+#define MEMORY_PER_LINE 256
+
+/* Enumeration for the states of a shard */
+typedef enum shard_state { PENDING_SHARD, RUNNING_SHARD, DONE_SHARD, FAILED_SHARD } shard_state;
+
+/* Forward declaration of the struct shard */
+typedef struct shard Shard;
+
+/* Pointer to the struct shard */
+typedef Shard *Shardptr;
+
+/* Forward declaration of the struct worker */
+typedef struct worker Worker;
+
+/* Pointer to the struct worker */
+typedef Worker *Workerptr;
+
+boolean write_all(int, char *, long);
+boolean read_all(int, char *, long);
+boolean send_number(int, long);
+boolean receive_number(int, long *);
+boolean send_bytes(int, char *, long);
+char *receive_bytes(int, long, long *);
+char *read_whole_file(char *, long *);
+boolean write_whole_file(char *, char *, long);
+boolean send_result_files(int, char *, char *, long);
+boolean receive_result_files(int, char *, long, char **, long *);
+void remove_result_files(char *);
+boolean serve_shard(int, long, char *, char *, long);
+char *get_scratch_directory(long);
+void remove_scratch_directory(long, char *);
+void serve_worker(int);
+boolean start_worker(Workerptr);
+void stop_worker(Workerptr, boolean);
+char *get_base_name(char *);
+boolean assign_shard(Workerptr, Shardptr, int);
+boolean receive_result(Workerptr, Shardptr);
+int compare_shards(const void *, const void *);
+void measure_source(Shardptr);
+long measure_peak_memory(void);
+int find_admissible_shard(Shardptr *, int);
+boolean fail_shard(Workerptr, Shardptr);
+void fail_overdue_shards(Shardptr, int *);
+void run_coordinator(int, char *[]);
+
+#endif
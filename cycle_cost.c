@@ -0,0 +1,689 @@
+/**
+ * This file contains the implementation of the static cycle-cost estimator. Each instruction is a node of the
+ * control-flow graph, with the next instruction and the target of jmp and bne as its successors; jsr continues with
+ * the next instruction and adds the cost of the called routine, while rts and stop end the routine. The depth-first
+ * search from the entry of each routine finds the back edges of its loops, the best and worst case cycles of its
+ * acyclic paths are computed without them, and each back edge closes a loop whose iteration cost is reported.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cycle_cost.h"
+#include "utils.h"
+#include "globals.h"
+#include "optimizer.h"
+#include "symbol_structs.h"
+#include "statement_structs.h"
+
+/* Definition of a statement in the statement list (linked list) */
+struct stmt {
+    int line_num; /* The line number of the statement in the extended source file */
+    char *source; /* A copy of the source line of the statement (kept only for the listing file), or NULL */
+    char label[MAX_SYMBOL_LEN + 1]; /* The symbol defined by the statement, or an empty string */
+    statement_type type; /* The type of the statement (instruction, directive) */
+    opcode op; /* The opcode of an instruction statement */
+    directive dir; /* The directive of a directive statement */
+    char src[MAX_OPERAND_LEN + 1]; /* The source operand, or an empty string */
+    char dest[MAX_OPERAND_LEN + 1]; /* The destination operand (or the symbol of .entry/.extern), or an empty string */
+    addressing_mode src_mode; /* The addressing mode of the source operand */
+    addressing_mode dest_mode; /* The addressing mode of the destination operand */
+    int src_value; /* The number of an immediate or register source operand */
+    int dest_value; /* The number of an immediate or register destination operand */
+    unsigned int address; /* The offset of the statement in the code or data segment */
+    int word_count; /* The number of words the statement occupies in its segment */
+    int fixup_start; /* The index of the first expression fixup of the statement */
+    int fixup_count; /* The number of expression fixups of the statement */
+    boolean is_removed; /* Indicates if the statement was removed by an optimization pass */
+    boolean is_referenced; /* Indicates if the statement can be reached or referenced by the program */
+    Stmtptr alias; /* The data statement whose words a removed data statement shares, or NULL */
+    Stmtptr next; /* Pointer to the next statement in the statement list */
+};
+
+/* Definition of the cost of an opcode in the cost table */
+struct opcode_cost {
+    int cycles; /* The cycles of the execution of the operation */
+    boolean reads_src; /* Indicates if the operation reads a direct source operand from memory */
+    boolean reads_dest; /* Indicates if the operation reads a direct destination operand from memory */
+    boolean writes_dest; /* Indicates if the operation writes a direct destination operand to memory */
+};
+
+/* The cost table, in the order of the opcodes (lea and the jumps only use the address of their direct operand) */
+static const struct opcode_cost opcode_costs[] = {
+    {1, TRUE, FALSE, TRUE}, /* mov */
+    {1, TRUE, TRUE, FALSE}, /* cmp */
+    {1, TRUE, TRUE, TRUE}, /* add */
+    {1, TRUE, TRUE, TRUE}, /* sub */
+    {1, FALSE, TRUE, TRUE}, /* not */
+    {1, FALSE, FALSE, TRUE}, /* clr */
+    {1, FALSE, FALSE, TRUE}, /* lea */
+    {1, FALSE, TRUE, TRUE}, /* inc */
+    {1, FALSE, TRUE, TRUE}, /* dec */
+    {1, FALSE, FALSE, FALSE}, /* jmp */
+    {1, FALSE, FALSE, FALSE}, /* bne */
+    {2, FALSE, FALSE, TRUE}, /* red */
+    {2, FALSE, TRUE, FALSE}, /* prn */
+    {2, FALSE, FALSE, FALSE}, /* jsr (pushes the return address) */
+    {2, FALSE, FALSE, FALSE}, /* rts (pops the return address) */
+    {1, FALSE, FALSE, FALSE} /* stop */
+};
+
+static Stmtptr instructions[MEM_SIZE]; /* The instructions of the program, in the order of the code segment */
+static int instruction_count; /* The number of instructions */
+static int address_indexes[MEM_SIZE]; /* The index of the instruction at each offset of the code segment, or -1 */
+static int successors[MEM_SIZE][2]; /* The instructions that may run after each instruction */
+static int successor_counts[MEM_SIZE]; /* The number of successors of each instruction */
+static boolean is_back_edge[MEM_SIZE][2]; /* Indicates if an edge closes a loop of the routine being searched */
+static int call_targets[MEM_SIZE]; /* The entry of the routine called by a jsr, or -1 */
+static boolean is_recursive_call[MEM_SIZE]; /* Indicates if a jsr calls a routine whose analysis is in progress */
+static boolean is_flow_unknown[MEM_SIZE]; /* Indicates if an instruction jumps through a register or extern, or is patched */
+static int visit_states[MEM_SIZE]; /* The state of each instruction in the search: 0 new, 1 on the path, 2 done */
+static boolean is_path_known[MEM_SIZE]; /* Indicates if the path cycles of an instruction were computed */
+static int path_best[MEM_SIZE]; /* The best case cycles from each instruction to the end of the routine */
+static int path_worst[MEM_SIZE]; /* The worst case cycles from each instruction to the end of the routine */
+static int worst_successors[MEM_SIZE]; /* The successor on the worst case path of each instruction, or -1 */
+static int loop_states[MEM_SIZE]; /* The state of each instruction in the loop search: 0 new, 1 in the loop, 2 out */
+static int loop_best[MEM_SIZE]; /* The best case cycles from each instruction to the back edge of the loop */
+static int loop_worst[MEM_SIZE]; /* The worst case cycles from each instruction to the back edge of the loop */
+static boolean is_routine_entry[MEM_SIZE]; /* Indicates if an instruction starts a routine */
+static routine_state routine_states[MEM_SIZE]; /* The state of the analysis of the routine of each entry */
+static int routine_best[MEM_SIZE]; /* The best case cycles of the routine of each entry */
+static int routine_worst[MEM_SIZE]; /* The worst case cycles of the routine of each entry */
+static boolean is_routine_partial[MEM_SIZE]; /* Indicates if the cycles of a routine leave out some of its flow */
+
+/**
+ * Computes the cycles of an instruction from the cost table: the fetch of its words, the execution of its operation
+ * and the memory accesses of its direct operands.
+ *
+ * @param stmt The instruction.
+ *
+ * @return The number of cycles of the instruction.
+ */
+int get_instruction_cycles(Stmtptr stmt) {
+    const struct opcode_cost *cost = &opcode_costs[stmt->op];
+    int cycles = stmt->word_count * FETCH_CYCLES + cost->cycles;
+
+    if (stmt->src_mode == DIRECT_ADDR && cost->reads_src) {
+        cycles += MEMORY_ACCESS_CYCLES;
+    }
+
+    if (stmt->dest_mode == DIRECT_ADDR && cost->reads_dest) {
+        cycles += MEMORY_ACCESS_CYCLES;
+    }
+
+    if (stmt->dest_mode == DIRECT_ADDR && cost->writes_dest) {
+        cycles += MEMORY_ACCESS_CYCLES;
+    }
+
+    return cycles;
+}
+
+/**
+ * Finds the instruction a jump or a call goes to.
+ *
+ * @param stmt The jmp, bne or jsr instruction.
+ *
+ * @return The index of the target instruction, or -1 if the target goes through a register or is not in the code.
+ *
+ * @remarks The function uses the symbol table, since the optimization passes may move a label to the next instruction.
+ */
+int find_code_target(Stmtptr stmt) {
+    Stmtptr target_stmt;
+    unsigned int address;
+
+    if (stmt->dest_mode != DIRECT_ADDR) {
+        return -1;
+    }
+
+    /* Extern symbols and data labels are not defined by an instruction of the program */
+    target_stmt = find_labeled_stmt(stmt->dest);
+    if (target_stmt == NULL || target_stmt->type != INSTRUCTION) {
+        return -1;
+    }
+
+    address = get_symbol_addr(symbol_table, stmt->dest) - MEM_START;
+    if (address >= (unsigned int)ic) {
+        return -1;
+    }
+
+    return address_indexes[address];
+}
+
+/**
+ * Builds the control-flow graph of the instructions in the statement list and finds the entries of the routines:
+ * the first instruction and the targets of jsr.
+ *
+ * @return The number of instructions.
+ *
+ * @remarks The function uses the global variables 'stmt_table' and 'ic', and must run after the optimization passes.
+ */
+int build_flow_graph(void) {
+    Stmtptr current_stmt;
+    int i;
+    int target;
+
+    instruction_count = 0;
+    for (i = 0; i < MEM_SIZE; i++) {
+        address_indexes[i] = -1;
+    }
+
+    for (current_stmt = find_next_instruction(stmt_table); current_stmt != NULL; current_stmt = find_next_instruction(current_stmt->next)) {
+        address_indexes[current_stmt->address] = instruction_count;
+        instructions[instruction_count++] = current_stmt;
+    }
+
+    for (i = 0; i < instruction_count; i++) {
+        successor_counts[i] = 0;
+        call_targets[i] = -1;
+        is_recursive_call[i] = FALSE;
+        /* The program may write other words over an instruction it patches, so its cost is not known */
+        is_flow_unknown[i] = is_patched_instruction(instructions[i]);
+        is_routine_entry[i] = i == 0;
+        routine_states[i] = NOT_ANALYSED;
+    }
+
+    for (i = 0; i < instruction_count; i++) {
+        opcode op = instructions[i]->op;
+
+        /* Every instruction but jmp, rts and stop may continue with the next one */
+        if (op != JMP_OP && op != RTS_OP && op != STOP_OP && i + 1 < instruction_count) {
+            successors[i][successor_counts[i]++] = i + 1;
+        }
+
+        if (op == JMP_OP || op == BNE_OP || op == JSR_OP) {
+            target = find_code_target(instructions[i]);
+            if (target == -1) {
+                is_flow_unknown[i] = TRUE;
+            } else if (op == JSR_OP) {
+                call_targets[i] = target;
+                is_routine_entry[target] = TRUE;
+            } else {
+                successors[i][successor_counts[i]++] = target;
+            }
+        }
+    }
+
+    return instruction_count;
+}
+
+/**
+ * Searches the instructions reachable from an instruction within its routine, marking the edges that go back to an
+ * instruction on the search path (the back edges of the loops).
+ *
+ * @param node The index of the instruction to search from.
+ *
+ * @remarks The caller must clear 'visit_states' before the search of each routine.
+ */
+void mark_back_edges(int node) {
+    int i;
+    int successor;
+
+    visit_states[node] = 1;
+
+    for (i = 0; i < successor_counts[node]; i++) {
+        successor = successors[node][i];
+        is_back_edge[node][i] = visit_states[successor] == 1;
+
+        if (visit_states[successor] == 0) {
+            mark_back_edges(successor);
+        }
+    }
+
+    visit_states[node] = 2;
+}
+
+/**
+ * Returns the cycles of an instruction, including the cycles of the routine it calls.
+ *
+ * @param node      The index of the instruction.
+ * @param is_worst  TRUE for the worst case cycles, FALSE for the best case cycles.
+ *
+ * @return The number of cycles.
+ */
+int get_node_cycles(int node, boolean is_worst) {
+    int cycles = get_instruction_cycles(instructions[node]);
+    int callee = call_targets[node];
+
+    if (callee != -1 && !is_recursive_call[node] && routine_states[callee] == ANALYSED) {
+        cycles += is_worst ? routine_worst[callee] : routine_best[callee];
+    }
+
+    return cycles;
+}
+
+/**
+ * Computes the best and worst case cycles of the acyclic paths from an instruction to the end of its routine,
+ * ignoring the back edges found by 'mark_back_edges'.
+ *
+ * @param node The index of the instruction.
+ *
+ * @remarks The caller must clear 'is_path_known' before the computation of each routine.
+ */
+void compute_path_cycles(int node) {
+    int i;
+    int successor;
+    int best = -1;
+    int worst = 0;
+
+    worst_successors[node] = -1;
+
+    for (i = 0; i < successor_counts[node]; i++) {
+        if (is_back_edge[node][i]) {
+            continue;
+        }
+
+        successor = successors[node][i];
+        if (!is_path_known[successor]) {
+            compute_path_cycles(successor);
+        }
+
+        if (best == -1 || path_best[successor] < best) {
+            best = path_best[successor];
+        }
+        if (path_worst[successor] > worst) {
+            worst = path_worst[successor];
+            worst_successors[node] = successor;
+        }
+    }
+
+    /* An instruction without successors other than back edges ends the path */
+    path_best[node] = get_node_cycles(node, FALSE) + (best == -1 ? 0 : best);
+    path_worst[node] = get_node_cycles(node, TRUE) + worst;
+    is_path_known[node] = TRUE;
+}
+
+/**
+ * Computes the best and worst case cycles of the paths of a loop from an instruction to the source of its back edge.
+ *
+ * @param node  The index of the instruction.
+ * @param tail  The index of the instruction whose back edge closes the loop.
+ *
+ * @return TRUE if the tail can be reached from the instruction without a back edge, FALSE otherwise.
+ *
+ * @remarks The caller must clear 'loop_states' before the computation of each loop.
+ */
+boolean compute_loop_cycles(int node, int tail) {
+    int i;
+    int successor;
+    int best = -1;
+    int worst = 0;
+
+    if (node == tail) {
+        loop_best[node] = get_node_cycles(node, FALSE);
+        loop_worst[node] = get_node_cycles(node, TRUE);
+        loop_states[node] = 1;
+        return TRUE;
+    }
+
+    for (i = 0; i < successor_counts[node]; i++) {
+        if (is_back_edge[node][i]) {
+            continue;
+        }
+
+        successor = successors[node][i];
+        if (loop_states[successor] == 0) {
+            compute_loop_cycles(successor, tail);
+        }
+
+        if (loop_states[successor] != 1) {
+            continue;
+        }
+
+        if (best == -1 || loop_best[successor] < best) {
+            best = loop_best[successor];
+        }
+        if (loop_worst[successor] > worst) {
+            worst = loop_worst[successor];
+        }
+    }
+
+    if (best == -1) {
+        loop_states[node] = 2;
+        return FALSE;
+    }
+
+    loop_best[node] = get_node_cycles(node, FALSE) + best;
+    loop_worst[node] = get_node_cycles(node, TRUE) + worst;
+    loop_states[node] = 1;
+    return TRUE;
+}
+
+/**
+ * Searches the routine that starts at an instruction and computes the cycles of its acyclic paths.
+ *
+ * @param entry The index of the first instruction of the routine.
+ */
+void search_routine(int entry) {
+    int i;
+
+    for (i = 0; i < instruction_count; i++) {
+        visit_states[i] = 0;
+        is_path_known[i] = FALSE;
+    }
+
+    mark_back_edges(entry);
+    compute_path_cycles(entry);
+}
+
+/**
+ * Analyses the routine that starts at an instruction, after analysing the routines it calls.
+ *
+ * @param entry The index of the first instruction of the routine.
+ *
+ * @remarks A routine that calls itself (directly or through other routines), that jumps or calls through a register
+ *          or an extern symbol, or whose instructions the program patches, is marked as partial: the cycles of the flow
+ *          that cannot be followed are left out.
+ */
+void analyse_routine(int entry) {
+    int *calls;
+    int call_count = 0;
+    int callee;
+    int i;
+
+    routine_states[entry] = ANALYSING;
+    is_routine_partial[entry] = FALSE;
+
+    /* Find the calls of the instructions reachable from the entry */
+    for (i = 0; i < instruction_count; i++) {
+        visit_states[i] = 0;
+    }
+    mark_back_edges(entry);
+
+    calls = (int *)malloc((instruction_count + 1) * sizeof(int));
+    if (calls == NULL) {
+        print_error(MEM_ALLOC_FAILED);
+        exit(1);
+    }
+
+    for (i = 0; i < instruction_count; i++) {
+        if (visit_states[i] == 0) {
+            continue;
+        }
+
+        if (is_flow_unknown[i]) {
+            is_routine_partial[entry] = TRUE;
+        }
+
+        if (call_targets[i] != -1) {
+            calls[call_count++] = i;
+        }
+    }
+
+    /* The analysis of a called routine reuses the search state, so the search is repeated after it */
+    for (i = 0; i < call_count; i++) {
+        callee = call_targets[calls[i]];
+
+        if (routine_states[callee] == NOT_ANALYSED) {
+            analyse_routine(callee);
+        }
+
+        /* A routine still being analysed is called recursively, and its cycles are left out of the call */
+        if (routine_states[callee] != ANALYSED) {
+            is_recursive_call[calls[i]] = TRUE;
+        }
+
+        if (is_recursive_call[calls[i]] || is_routine_partial[callee]) {
+            is_routine_partial[entry] = TRUE;
+        }
+    }
+
+    free(calls);
+
+    search_routine(entry);
+
+    routine_best[entry] = path_best[entry];
+    routine_worst[entry] = path_worst[entry];
+    routine_states[entry] = ANALYSED;
+}
+
+/**
+ * Builds the control-flow graph of the program and analyses each of its routines.
+ *
+ * @return The number of instructions.
+ */
+int analyse_program(void) {
+    int entry;
+
+    if (build_flow_graph() == 0) {
+        return 0;
+    }
+
+    for (entry = 0; entry < instruction_count; entry++) {
+        if (is_routine_entry[entry] && routine_states[entry] == NOT_ANALYSED) {
+            analyse_routine(entry);
+        }
+    }
+
+    return instruction_count;
+}
+
+/**
+ * Returns the name of a routine, for the reports.
+ *
+ * @param entry The index of the first instruction of the routine.
+ *
+ * @return The label of the first instruction, or "(start)" if it has none.
+ */
+char *get_routine_name(int entry) {
+    return instructions[entry]->label[0] != '\0' ? instructions[entry]->label : "(start)";
+}
+
+/**
+ * Prints the cycle estimate of each routine of the program to the standard output: the best and worst case cycles of
+ * its acyclic paths, and the best and worst case cycles of one iteration of each of its loops.
+ *
+ * @param name The name of the program, printed at the start of the report.
+ *
+ * @remarks The function uses the global variable 'stmt_table', and must run after the optimization passes.
+ */
+void print_cycle_report(char *name) {
+    int entry;
+    int node;
+    int i;
+    int j;
+    Stmtptr stmt;
+
+    if (analyse_program() == 0) {
+        return;
+    }
+
+    printf("%s: Cycle estimate (%d per word fetched, %d per memory operand access)\n", name, FETCH_CYCLES, MEMORY_ACCESS_CYCLES);
+
+    for (entry = 0; entry < instruction_count; entry++) {
+        if (!is_routine_entry[entry]) {
+            continue;
+        }
+
+        stmt = instructions[entry];
+        printf("  Routine %s (line %d): best %d, worst %d cycles%s\n", get_routine_name(entry), stmt->line_num,
+               routine_best[entry], routine_worst[entry], is_routine_partial[entry] ? " (indirect, extern, recursive or patched flow left out)" : "");
+
+        /* Search the routine again to find its back edges, each of which closes a loop */
+        for (i = 0; i < instruction_count; i++) {
+            visit_states[i] = 0;
+        }
+        mark_back_edges(entry);
+
+        for (node = 0; node < instruction_count; node++) {
+            if (visit_states[node] == 0) {
+                continue;
+            }
+
+            for (i = 0; i < successor_counts[node]; i++) {
+                if (!is_back_edge[node][i]) {
+                    continue;
+                }
+
+                for (j = 0; j < instruction_count; j++) {
+                    loop_states[j] = 0;
+                }
+                compute_loop_cycles(successors[node][i], node);
+
+                stmt = instructions[successors[node][i]];
+                printf("    Loop at %s (line %d): best %d, worst %d cycles per iteration\n", stmt->label[0] != '\0' ? stmt->label : "(unlabeled)",
+                       stmt->line_num, loop_best[successors[node][i]], loop_worst[successors[node][i]]);
+            }
+        }
+    }
+}
+
+/**
+ * Follows the worst case path of a routine, summing the cycles of its own instructions and counting its calls.
+ *
+ * @param entry         The index of the first instruction of the routine.
+ * @param callees       Filled with the entries of the called routines, in the order of their first call on the path.
+ * @param call_counts   Filled with the number of calls of each called routine on the path.
+ * @param exclusive     Set to the cycles of the instructions of the routine itself on the path.
+ *
+ * @return The number of called routines.
+ *
+ * @remarks The recursive calls are left out, as they are in the cycles of the routine.
+ */
+int collect_worst_calls(int entry, int *callees, int *call_counts, int *exclusive) {
+    int node;
+    int callee;
+    int count = 0;
+    int i;
+
+    search_routine(entry);
+    *exclusive = 0;
+
+    for (node = entry; node != -1; node = worst_successors[node]) {
+        *exclusive += get_instruction_cycles(instructions[node]);
+
+        callee = call_targets[node];
+        if (callee == -1 || is_recursive_call[node]) {
+            continue;
+        }
+
+        for (i = 0; i < count && callees[i] != callee; i++);
+        if (i == count) {
+            callees[count] = callee;
+            call_counts[count++] = 0;
+        }
+        call_counts[i]++;
+    }
+
+    return count;
+}
+
+/**
+ * Writes the folded stacks of a routine and of the routines it calls on its worst case path: one line per call stack,
+ * the names of the routines separated by semicolons followed by the cycles spent in the last one.
+ *
+ * @param fd            The file descriptor of the folded stacks file.
+ * @param entry         The index of the first instruction of the routine.
+ * @param stack         The call stack of the caller, or an empty string for the first routine.
+ * @param multiplier    The number of times the routine is called through this call stack.
+ *
+ * @remarks Calls that are not recursive always go to a routine whose analysis ended first, so the recursion ends.
+ */
+void write_folded_stacks(FILE *fd, int entry, char *stack, long multiplier) {
+    char *routine_stack;
+    int *callees;
+    int *call_counts;
+    int count;
+    int exclusive;
+    int i;
+
+    routine_stack = (char *)malloc((strlen(stack) + MAX_SYMBOL_LEN + 2) * sizeof(char));
+    callees = (int *)malloc((instruction_count + 1) * sizeof(int));
+    call_counts = (int *)malloc((instruction_count + 1) * sizeof(int));
+    if (routine_stack == NULL || callees == NULL || call_counts == NULL) {
+        print_error(MEM_ALLOC_FAILED);
+        exit(1);
+    }
+
+    if (stack[0] != '\0') {
+        sprintf(routine_stack, "%s;%s", stack, get_routine_name(entry));
+    } else {
+        strcpy(routine_stack, get_routine_name(entry));
+    }
+
+    count = collect_worst_calls(entry, callees, call_counts, &exclusive);
+    fprintf(fd, "%s %ld\n", routine_stack, exclusive * multiplier);
+
+    for (i = 0; i < count; i++) {
+        write_folded_stacks(fd, callees[i], routine_stack, multiplier * call_counts[i]);
+    }
+
+    free(routine_stack);
+    free(callees);
+    free(call_counts);
+}
+
+/**
+ * Prints the call profile of the worst case paths of the program to the standard output. For each routine the profile
+ * gives the inclusive cycles (with the called routines) and the exclusive cycles (its own instructions), and the
+ * cycles of each caller to callee edge.
+ *
+ * @param name The name of the program, used for the report.
+ *
+ * @remarks The function uses the global variable 'stmt_table', and must run after the optimization passes.
+ */
+void print_call_profile(char *name) {
+    int *callees;
+    int *call_counts;
+    int count;
+    int exclusive;
+    int entry;
+    int i;
+
+    if (analyse_program() == 0) {
+        return;
+    }
+
+    callees = (int *)malloc((instruction_count + 1) * sizeof(int));
+    call_counts = (int *)malloc((instruction_count + 1) * sizeof(int));
+    if (callees == NULL || call_counts == NULL) {
+        print_error(MEM_ALLOC_FAILED);
+        exit(1);
+    }
+
+    printf("%s: Call profile of the worst case paths\n", name);
+
+    for (entry = 0; entry < instruction_count; entry++) {
+        if (!is_routine_entry[entry]) {
+            continue;
+        }
+
+        count = collect_worst_calls(entry, callees, call_counts, &exclusive);
+        printf("  Routine %s: inclusive %d, exclusive %d cycles\n", get_routine_name(entry), path_worst[entry], exclusive);
+
+        for (i = 0; i < count; i++) {
+            printf("    Calls %s %d times: %d cycles\n", get_routine_name(callees[i]), call_counts[i], call_counts[i] * routine_worst[callees[i]]);
+        }
+    }
+
+    free(callees);
+    free(call_counts);
+}
+
+/**
+ * Writes the folded stacks file (.fld) of the worst case paths of the program, for flame graph tools.
+ *
+ * @param name The name of the program, used for the name of the folded stacks file.
+ *
+ * @remarks The function uses the global variable 'stmt_table', and runs with the output files, after a successful
+ *          second pass.
+ */
+void write_call_profile(char *name) {
+    char *modified_filename_folded;
+    FILE *folded_fd;
+
+    if (analyse_program() == 0) {
+        return;
+    }
+
+    modified_filename_folded = generate_new_filename(name, FILE_FOLDED);
+    folded_fd = fopen(modified_filename_folded, "w");
+    free(modified_filename_folded);
+
+    if (folded_fd == NULL) {
+        print_error(CANNOT_CREATE_FILE);
+        return;
+    }
+
+    write_folded_stacks(folded_fd, 0, "", 1);
+    fclose(folded_fd);
+}
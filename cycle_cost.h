@@ -0,0 +1,37 @@
+/**
+ * This header file declares the functions of the static cycle-cost estimator. The estimator builds a control-flow
+ * graph of the instructions in the statement list, prices each instruction with a per-opcode and per-addressing-mode
+ * cost table, and reports the best and worst case cycle counts of each routine and of each loop iteration.
+ */
+
+#ifndef ASM_CYCLE_COST_H
+#define ASM_CYCLE_COST_H
+
+#include <stdio.h>
+#include "utils.h"
+#include "statement_structs.h"
+
+#define FETCH_CYCLES 1 /* The cycles to fetch each word of an instruction */
+#define MEMORY_ACCESS_CYCLES 1 /* The cycles of each read or write of a direct operand in memory */
+
+/* Enumeration for the states of the analysis of a routine */
+typedef enum routine_state { NOT_ANALYSED, ANALYSING, ANALYSED } routine_state;
+
+int get_instruction_cycles(Stmtptr);
+int find_code_target(Stmtptr);
+int build_flow_graph(void);
+void mark_back_edges(int);
+int get_node_cycles(int, boolean);
+void compute_path_cycles(int);
+boolean compute_loop_cycles(int, int);
+void search_routine(int);
+void analyse_routine(int);
+int analyse_program(void);
+char *get_routine_name(int);
+void print_cycle_report(char *);
+int collect_worst_calls(int, int *, int *, int *);
+void write_folded_stacks(FILE *, int, char *, long);
+void print_call_profile(char *);
+void write_call_profile(char *);
+
+#endif
@@ -0,0 +1,728 @@
+/**
+ * This file contains the implementation of assembly-time constants and integer expressions. Expressions combine
+ * numbers, constants and symbols with + - * / and parentheses. They are parsed into a postfix bytecode shared by the
+ * whole program: an expression of numbers and known constants is evaluated right away, and any other expression is
+ * kept as a fixup of its statement and evaluated by fold_expressions once the symbol addresses are final.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "expression.h"
+#include "utils.h"
+#include "globals.h"
+#include "symbol_structs.h"
+#include "statement_structs.h"
+
+/* Definition of a statement in the statement list (linked list) */
+struct stmt {
+    int line_num; /* The line number of the statement in the extended source file */
+    char *source; /* A copy of the source line of the statement (kept only for the listing file), or NULL */
+    char label[MAX_SYMBOL_LEN + 1]; /* The symbol defined by the statement, or an empty string */
+    statement_type type; /* The type of the statement (instruction, directive) */
+    opcode op; /* The opcode of an instruction statement */
+    directive dir; /* The directive of a directive statement */
+    char src[MAX_OPERAND_LEN + 1]; /* The source operand, or an empty string */
+    char dest[MAX_OPERAND_LEN + 1]; /* The destination operand (or the symbol of .entry/.extern), or an empty string */
+    addressing_mode src_mode; /* The addressing mode of the source operand */
+    addressing_mode dest_mode; /* The addressing mode of the destination operand */
+    int src_value; /* The number of an immediate or register source operand */
+    int dest_value; /* The number of an immediate or register destination operand */
+    unsigned int address; /* The offset of the statement in the code or data segment */
+    int word_count; /* The number of words the statement occupies in its segment */
+    int fixup_start; /* The index of the first expression fixup of the statement */
+    int fixup_count; /* The number of expression fixups of the statement */
+    boolean is_removed; /* Indicates if the statement was removed by an optimization pass */
+    boolean is_referenced; /* Indicates if the statement can be reached or referenced by the program */
+    Stmtptr alias; /* The data statement whose words a removed data statement shares, or NULL */
+    Stmtptr next; /* Pointer to the next statement in the statement list */
+};
+
+/* Definition of a constant defined by an .equ or .set directive (linked list) */
+struct constant {
+    char name[MAX_SYMBOL_LEN + 1]; /* The name of the constant */
+    int value; /* The value of the constant, if it is known */
+    int expr_start; /* The start of the expression of the constant in the bytecode, or -1 if the value is known */
+    boolean is_set; /* Indicates if the constant was defined by .set and can be redefined */
+    int line_num; /* The line number of the latest definition of the constant */
+    Constptr next; /* Pointer to the next constant in the constant table */
+};
+
+/* Definition of an expression whose value is stored in a statement once it is folded */
+struct fixup {
+    int word; /* The word of a data statement, or 0 for the source and 1 for the destination operand of an instruction */
+    int expr_start; /* The start of the expression in the bytecode */
+};
+
+static int *expr_code; /* The bytecode of the expressions */
+static int expr_code_len; /* The number of used entries of the bytecode */
+static int expr_code_capacity; /* The number of entries the bytecode can hold */
+static char *expr_names; /* The names of the symbols used by the expressions, each terminated by a null character */
+static int expr_names_len; /* The number of used characters of the names */
+static int expr_names_capacity; /* The number of characters the names can hold */
+static struct fixup *fixups; /* The fixups of the statements, in the order of the statements */
+static int fixup_count; /* The number of fixups */
+static int fixup_capacity; /* The number of fixups the array can hold */
+static Constptr const_table; /* The constants defined by the program */
+
+/**
+ * Parses an expression into the bytecode, and evaluates it right away if it only uses numbers and known constants.
+ *
+ * @param text          The expression, without whitespaces.
+ * @param value         Receives the value of the expression, if it was evaluated.
+ * @param expr_start    Receives the start of the expression in the bytecode, or -1 if it was evaluated.
+ *
+ * @return TRUE if the expression is valid, FALSE otherwise.
+ */
+boolean parse_expression(char *text, int *value, int *expr_start) {
+    int code_len = expr_code_len;
+    int names_len = expr_names_len;
+    int label_weight;
+    err error;
+
+    /* An expression has the length of an operand, which also bounds the depth of the evaluation stack */
+    if (strlen(text) > MAX_OPERAND_LEN || !parse_sum(&text) || *text != '\0') {
+        expr_code_len = code_len;
+        expr_names_len = names_len;
+        return FALSE;
+    }
+    append_expr_code(END_EXPR_OP);
+
+    /* Fold the expression now and drop its bytecode if it does not depend on the symbol addresses */
+    if (!has_expr_symbols(code_len) && evaluate_expression(code_len, value, &label_weight, 0, &error)) {
+        expr_code_len = code_len;
+        *expr_start = -1;
+        return TRUE;
+    }
+
+    *value = 0;
+    *expr_start = code_len;
+
+    return TRUE;
+}
+
+/**
+ * Parses a sum: products separated by '+' or '-'.
+ *
+ * @param text A pointer to the position in the expression, advanced past the sum.
+ *
+ * @return TRUE if the sum is valid, FALSE otherwise.
+ */
+boolean parse_sum(char **text) {
+    char op;
+
+    if (!parse_product(text)) {
+        return FALSE;
+    }
+
+    while (**text == '+' || **text == '-') {
+        op = *(*text)++;
+        if (!parse_product(text)) {
+            return FALSE;
+        }
+        append_expr_code(op == '+' ? ADD_EXPR_OP : SUB_EXPR_OP);
+    }
+
+    return TRUE;
+}
+
+/**
+ * Parses a product: factors separated by '*' or '/'.
+ *
+ * @param text A pointer to the position in the expression, advanced past the product.
+ *
+ * @return TRUE if the product is valid, FALSE otherwise.
+ */
+boolean parse_product(char **text) {
+    char op;
+
+    if (!parse_factor(text)) {
+        return FALSE;
+    }
+
+    while (**text == '*' || **text == '/') {
+        op = *(*text)++;
+        if (!parse_factor(text)) {
+            return FALSE;
+        }
+        append_expr_code(op == '*' ? MUL_EXPR_OP : DIV_EXPR_OP);
+    }
+
+    return TRUE;
+}
+
+/**
+ * Parses a factor: a signed factor, a parenthesized sum, a number or a symbol.
+ *
+ * @param text A pointer to the position in the expression, advanced past the factor.
+ *
+ * @return TRUE if the factor is valid, FALSE otherwise.
+ */
+boolean parse_factor(char **text) {
+    unsigned int number = 0;
+
+    switch (**text) {
+        case '-':
+            (*text)++;
+            if (!parse_factor(text)) {
+                return FALSE;
+            }
+            append_expr_code(NEG_EXPR_OP);
+            return TRUE;
+
+        case '+':
+            (*text)++;
+            return parse_factor(text);
+
+        case '(':
+            (*text)++;
+            if (!parse_sum(text) || **text != ')') {
+                return FALSE;
+            }
+            (*text)++;
+            return TRUE;
+
+        default:
+            break;
+    }
+
+    if (isdigit(**text)) {
+        /* A number beyond the range of the expressions is kept just beyond it, and reported when it is evaluated */
+        while (isdigit(**text)) {
+            number = number * 10 + (*(*text)++ - '0');
+            if (number > MAX_EXPR_MAGNITUDE) {
+                number = MAX_EXPR_MAGNITUDE + 1;
+            }
+        }
+        append_expr_code(NUM_EXPR_OP);
+        append_expr_code((int)number);
+        return TRUE;
+    }
+
+    return parse_expr_symbol(text);
+}
+
+/**
+ * Parses a symbol of an expression. A known constant is inlined, any other symbol is looked up when the expression
+ * is folded.
+ *
+ * @param text A pointer to the position in the expression, advanced past the symbol.
+ *
+ * @return TRUE if the symbol is valid, FALSE otherwise.
+ */
+boolean parse_expr_symbol(char **text) {
+    char name[MAX_SYMBOL_LEN + 1];
+    Constptr constant;
+    char *new_names;
+    int len = 0;
+
+    if (!isalpha(**text)) {
+        return FALSE;
+    }
+
+    while (isalnum((*text)[len])) {
+        if (len == MAX_SYMBOL_LEN) {
+            return FALSE;
+        }
+        name[len] = (*text)[len];
+        len++;
+    }
+    name[len] = '\0';
+    *text += len;
+
+    if (classify_word(name, NULL) != IDENTIFIER_WORD) {
+        return FALSE;
+    }
+
+    /* A constant refers to its current definition, so a later .set does not change the expression */
+    constant = find_constant(name);
+    if (constant != NULL && constant->expr_start == -1) {
+        append_expr_code(NUM_EXPR_OP);
+        append_expr_code(constant->value);
+        return TRUE;
+    } else if (constant != NULL) {
+        append_expr_code(CONST_EXPR_OP);
+        append_expr_code(constant->expr_start);
+        return TRUE;
+    }
+
+    /* Add the name to the names of the expressions, doubling their capacity when they are full */
+    if (expr_names_len + len + 1 > expr_names_capacity) {
+        expr_names_capacity = expr_names_capacity ? expr_names_capacity * 2 : EXPR_INITIAL_CAPACITY;
+        new_names = (char *)realloc(expr_names, expr_names_capacity * sizeof(char));
+        if (new_names == NULL) {
+            print_error(MEM_REALLOC_FAILED);
+            exit(1);
+        }
+        expr_names = new_names;
+    }
+    strcpy(expr_names + expr_names_len, name);
+
+    append_expr_code(SYMBOL_EXPR_OP);
+    append_expr_code(expr_names_len);
+    expr_names_len += len + 1;
+
+    return TRUE;
+}
+
+/**
+ * Appends an entry to the bytecode of the expressions.
+ *
+ * @param entry The operation or operand to append.
+ */
+void append_expr_code(int entry) {
+    int *new_code;
+
+    /* Double the capacity of the bytecode when it is full */
+    if (expr_code_len == expr_code_capacity) {
+        expr_code_capacity = expr_code_capacity ? expr_code_capacity * 2 : EXPR_INITIAL_CAPACITY;
+        new_code = (int *)realloc(expr_code, expr_code_capacity * sizeof(int));
+        if (new_code == NULL) {
+            print_error(MEM_REALLOC_FAILED);
+            exit(1);
+        }
+        expr_code = new_code;
+    }
+
+    expr_code[expr_code_len++] = entry;
+}
+
+/**
+ * Checks if an expression uses a symbol or a constant whose value is not known yet.
+ *
+ * @param expr_start The start of the expression in the bytecode.
+ *
+ * @return TRUE if the expression depends on a symbol, FALSE otherwise.
+ */
+boolean has_expr_symbols(int expr_start) {
+    int pc;
+
+    for (pc = expr_start; expr_code[pc] != END_EXPR_OP; pc++) {
+        switch (expr_code[pc]) {
+            case SYMBOL_EXPR_OP:
+            case CONST_EXPR_OP:
+                return TRUE;
+            case NUM_EXPR_OP:
+                pc++; /* Skip the operand */
+                break;
+            default:
+                break;
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * Combines the label weights of the operands of an operation. The label weight of a value is the number of times it
+ * counts the address of a label: 1 for an address plus or minus a number, 0 for a number or a difference of two
+ * addresses, whose value does not depend on where the program is loaded.
+ *
+ * @param op        The operation.
+ * @param first     The label weight of the first operand (the only one of a negation).
+ * @param second    The label weight of the second operand.
+ *
+ * @return The label weight of the result, or NONLINEAR_LABEL_WEIGHT if the result is not a multiple of an address.
+ */
+int combine_label_weights(expr_op op, int first, int second) {
+    int weight;
+
+    if (first == NONLINEAR_LABEL_WEIGHT || second == NONLINEAR_LABEL_WEIGHT) {
+        return NONLINEAR_LABEL_WEIGHT;
+    }
+
+    if (op == NEG_EXPR_OP) {
+        weight = -first;
+    } else if (op == ADD_EXPR_OP) {
+        weight = first + second;
+    } else if (op == SUB_EXPR_OP) {
+        weight = first - second;
+    } else {
+        /* A product or a quotient of an address is not an address */
+        weight = first == 0 && second == 0 ? 0 : NONLINEAR_LABEL_WEIGHT;
+    }
+
+    return weight > MAX_EXPR_SYMBOLS || weight < -MAX_EXPR_SYMBOLS ? NONLINEAR_LABEL_WEIGHT : weight;
+}
+
+/**
+ * Evaluates an expression of the bytecode.
+ *
+ * @param expr_start    The start of the expression in the bytecode.
+ * @param value         Receives the value of the expression.
+ * @param label_weight  Receives the label weight of the value (see combine_label_weights).
+ * @param depth         The number of constants whose evaluation led to this expression.
+ * @param error         Receives the reason the expression cannot be evaluated.
+ *
+ * @return TRUE if the expression was evaluated, FALSE otherwise.
+ *
+ * @remarks The function uses the global variable 'symbol_table' to find the addresses of the symbols. Every value on
+ *          the way must be within MAX_EXPR_MAGNITUDE, so the operations cannot overflow.
+ */
+boolean evaluate_expression(int expr_start, int *value, int *label_weight, int depth, err *error) {
+    long stack[MAX_EXPR_STACK];
+    int weights[MAX_EXPR_STACK];
+    int top = 0;
+    int pc = expr_start;
+    int number;
+    int weight;
+    long operand;
+    expr_op op;
+
+    /* Constants that refer to each other (directly or not) would be evaluated forever */
+    if (depth > MAX_EXPR_DEPTH) {
+        *error = EXPR_TOO_DEEP;
+        return FALSE;
+    }
+
+    while ((op = (expr_op)expr_code[pc++]) != END_EXPR_OP) {
+        switch (op) {
+            case NUM_EXPR_OP:
+                stack[top] = expr_code[pc++];
+                weights[top++] = 0;
+                break;
+            case SYMBOL_EXPR_OP:
+                if (!resolve_expr_symbol(expr_names + expr_code[pc++], &number, &weight, depth, error)) {
+                    return FALSE;
+                }
+                stack[top] = number;
+                weights[top++] = weight;
+                break;
+            case CONST_EXPR_OP:
+                if (!evaluate_expression(expr_code[pc++], &number, &weight, depth + 1, error)) {
+                    return FALSE;
+                }
+                stack[top] = number;
+                weights[top++] = weight;
+                break;
+            case NEG_EXPR_OP:
+                stack[top - 1] = -stack[top - 1];
+                weights[top - 1] = combine_label_weights(op, weights[top - 1], 0);
+                break;
+            default:
+                /* A binary operation replaces its two operands with its result */
+                operand = stack[--top];
+                weights[top - 1] = combine_label_weights(op, weights[top - 1], weights[top]);
+                if (op == ADD_EXPR_OP) {
+                    stack[top - 1] += operand;
+                } else if (op == SUB_EXPR_OP) {
+                    stack[top - 1] -= operand;
+                } else if (op == MUL_EXPR_OP) {
+                    stack[top - 1] *= operand;
+                } else if (operand == 0) {
+                    *error = EXPR_DIV_BY_ZERO;
+                    return FALSE;
+                } else {
+                    stack[top - 1] /= operand;
+                }
+                break;
+        }
+
+        /* The operands are within the range, so their sum or product fits in a long */
+        if (stack[top - 1] > MAX_EXPR_MAGNITUDE || stack[top - 1] < -MAX_EXPR_MAGNITUDE) {
+            *error = EXPR_OUT_OF_RANGE;
+            return FALSE;
+        }
+    }
+
+    *value = (int)stack[0];
+    *label_weight = weights[0];
+
+    return TRUE;
+}
+
+/**
+ * Finds the value of a symbol used by an expression: a constant defined after the expression, or a label.
+ *
+ * @param name          The name of the symbol.
+ * @param value         Receives the value of the symbol.
+ * @param label_weight  Receives the label weight of the value: 1 for a label, that of the expression for a constant.
+ * @param depth         The number of constants whose evaluation led to this symbol.
+ * @param error         Receives the reason the symbol has no value.
+ *
+ * @return TRUE if the symbol has a value, FALSE otherwise.
+ */
+boolean resolve_expr_symbol(char *name, int *value, int *label_weight, int depth, err *error) {
+    Constptr constant = find_constant(name);
+
+    if (constant != NULL && constant->expr_start == -1) {
+        *value = constant->value;
+        *label_weight = 0;
+        return TRUE;
+    } else if (constant != NULL) {
+        return evaluate_expression(constant->expr_start, value, label_weight, depth + 1, error);
+    }
+
+    if (!is_existing_symbol(symbol_table, name)) {
+        *error = EXPR_UNDEFINED_SYMBOL;
+        return FALSE;
+    }
+
+    /* The address of an external symbol is only known when the program is linked */
+    if (is_extern_symbol(symbol_table, name)) {
+        *error = EXPR_EXTERN_SYMBOL;
+        return FALSE;
+    }
+
+    *value = (int)get_symbol_addr(symbol_table, name);
+    *label_weight = 1;
+
+    return TRUE;
+}
+
+/**
+ * Collects the names of the labels an expression uses, including those used by the constants it refers to.
+ *
+ * @param expr_start    The start of the expression in the bytecode.
+ * @param names         The array receiving the names, which can hold MAX_EXPR_SYMBOLS names.
+ * @param count         The number of names already in the array.
+ * @param depth         The number of constants whose expressions led to this expression.
+ *
+ * @return The number of names in the array.
+ */
+int collect_expr_symbols(int expr_start, char **names, int count, int depth) {
+    Constptr constant;
+    int pc;
+
+    if (depth > MAX_EXPR_DEPTH) {
+        return count;
+    }
+
+    for (pc = expr_start; expr_code[pc] != END_EXPR_OP; pc++) {
+        switch (expr_code[pc]) {
+            case NUM_EXPR_OP:
+                pc++; /* Skip the operand */
+                break;
+            case CONST_EXPR_OP:
+                count = collect_expr_symbols(expr_code[++pc], names, count, depth + 1);
+                break;
+            case SYMBOL_EXPR_OP:
+                constant = find_constant(expr_names + expr_code[++pc]);
+                if (constant != NULL && constant->expr_start != -1) {
+                    count = collect_expr_symbols(constant->expr_start, names, count, depth + 1);
+                } else if (constant == NULL && count < MAX_EXPR_SYMBOLS) {
+                    names[count++] = expr_names + expr_code[pc];
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Finds a constant in the constant table.
+ *
+ * @param name The name of the constant.
+ *
+ * @return A pointer to the constant, or NULL if it is not defined.
+ */
+Constptr find_constant(char *name) {
+    Constptr current = const_table;
+
+    while (current != NULL) {
+        if (strcmp(current->name, name) == 0) {
+            return current;
+        }
+        current = current->next;
+    }
+
+    return NULL;
+}
+
+/**
+ * Defines a constant, or redefines a constant that was defined by .set.
+ *
+ * @param name      The name of the constant.
+ * @param text      The expression of the constant, without whitespaces.
+ * @param is_set    Indicates if the constant is defined by .set (TRUE) or .equ (FALSE).
+ *
+ * @return TRUE if the constant was defined, FALSE otherwise.
+ *
+ * @remarks The function uses the global variables 'symbol_table' and 'line_num'.
+ */
+boolean define_constant(char *name, char *text, boolean is_set) {
+    Constptr constant = find_constant(name);
+    int value;
+    int expr_start;
+    int label_weight;
+    err error;
+
+    if (constant != NULL && !(is_set && constant->is_set)) {
+        print_error(CONST_REDEFINED);
+        return FALSE;
+    }
+
+    if (is_existing_symbol(symbol_table, name)) {
+        print_error(CONST_IS_SYMBOL);
+        return FALSE;
+    }
+
+    /* The expression is parsed before the constant changes, so a .set can refer to the previous value */
+    if (!parse_expression(text, &value, &expr_start)) {
+        print_error(CONST_INVALID_EXPR);
+        return FALSE;
+    }
+
+    /* An expression of numbers and known constants that was not folded cannot be evaluated, which is reported here */
+    if (expr_start != -1 && !has_expr_symbols(expr_start)) {
+        evaluate_expression(expr_start, &value, &label_weight, 0, &error);
+        print_error(error);
+        return FALSE;
+    }
+
+    if (constant == NULL) {
+        constant = (Constptr)malloc(sizeof(Constant));
+        if (constant == NULL) {
+            print_error(MEM_ALLOC_FAILED);
+            exit(1);
+        }
+        strcpy(constant->name, name);
+        constant->is_set = is_set;
+        constant->next = const_table;
+        const_table = constant;
+    }
+
+    constant->value = value;
+    constant->expr_start = expr_start;
+    constant->line_num = line_num;
+
+    return TRUE;
+}
+
+/**
+ * Returns the number of fixups, which is the index of the next fixup to be added.
+ *
+ * @return The number of fixups.
+ */
+int get_fixup_count(void) {
+    return fixup_count;
+}
+
+/**
+ * Adds a fixup for the current statement.
+ *
+ * @param word          The word of a data statement, or 0 for the source and 1 for the destination operand of an instruction.
+ * @param expr_start    The start of the expression in the bytecode.
+ */
+void add_fixup(int word, int expr_start) {
+    struct fixup *new_fixups;
+
+    /* Double the capacity of the fixups when they are full */
+    if (fixup_count == fixup_capacity) {
+        fixup_capacity = fixup_capacity ? fixup_capacity * 2 : EXPR_INITIAL_CAPACITY;
+        new_fixups = (struct fixup *)realloc(fixups, fixup_capacity * sizeof(struct fixup));
+        if (new_fixups == NULL) {
+            print_error(MEM_REALLOC_FAILED);
+            exit(1);
+        }
+        fixups = new_fixups;
+    }
+
+    fixups[fixup_count].word = word;
+    fixups[fixup_count].expr_start = expr_start;
+    fixup_count++;
+}
+
+/**
+ * Returns the expression of a fixup.
+ *
+ * @param index The index of the fixup.
+ *
+ * @return The start of the expression in the bytecode.
+ */
+int get_fixup_expr(int index) {
+    return fixups[index].expr_start;
+}
+
+/**
+ * Evaluates the expressions that depend on the symbol addresses and stores their values in their statements.
+ * It runs after the optimization passes, when the addresses are final.
+ *
+ * @return TRUE if every expression was evaluated, FALSE otherwise.
+ *
+ * @remarks The function uses the global variables 'stmt_table', 'symbol_table', 'data' and 'line_num'.
+ */
+boolean fold_expressions(void) {
+    boolean success = TRUE;
+    Stmtptr current_stmt;
+    Constptr constant;
+    int i, value, label_weight;
+    err error;
+
+    /* A symbol defined after a constant with the same name is only found now */
+    for (constant = const_table; constant != NULL; constant = constant->next) {
+        line_num = constant->line_num;
+        if (is_existing_symbol(symbol_table, constant->name)) {
+            print_error(CONST_IS_SYMBOL);
+            success = FALSE;
+        } else if (constant->expr_start != -1 && !evaluate_expression(constant->expr_start, &value, &label_weight, 0, &error)) {
+            /* The expression of a constant that uses labels is reported at its definition too */
+            print_error(error);
+            success = FALSE;
+        }
+    }
+
+    for (current_stmt = stmt_table; current_stmt != NULL; current_stmt = current_stmt->next) {
+        if (current_stmt->is_removed) {
+            continue;
+        }
+
+        line_num = current_stmt->line_num;
+
+        for (i = current_stmt->fixup_start; i < current_stmt->fixup_start + current_stmt->fixup_count; i++) {
+            if (!evaluate_expression(fixups[i].expr_start, &value, &label_weight, 0, &error)) {
+                print_error(error);
+                success = FALSE;
+                continue;
+            }
+
+            /* An immediate is encoded as an absolute word, so it can only use labels in differences of addresses */
+            if (current_stmt->type != DIRECTIVE && label_weight != 0) {
+                print_error(EXPR_RELOCATABLE_IMMEDIATE);
+                success = FALSE;
+                continue;
+            }
+
+            if (current_stmt->type == DIRECTIVE) {
+                data[current_stmt->address + fixups[i].word] = (unsigned int)value;
+            } else if (fixups[i].word == 0) {
+                current_stmt->src_value = value;
+            } else {
+                current_stmt->dest_value = value;
+            }
+        }
+    }
+
+    return success;
+}
+
+/**
+ * Frees the bytecode, the fixups and the constant table of the program.
+ */
+void free_expressions(void) {
+    Constptr next;
+
+    free(expr_code);
+    expr_code = NULL;
+    expr_code_len = 0;
+    expr_code_capacity = 0;
+
+    free(expr_names);
+    expr_names = NULL;
+    expr_names_len = 0;
+    expr_names_capacity = 0;
+
+    free(fixups);
+    fixups = NULL;
+    fixup_count = 0;
+    fixup_capacity = 0;
+
+    while (const_table != NULL) {
+        next = const_table->next;
+        free(const_table);
+        const_table = next;
+    }
+}
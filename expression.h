@@ -0,0 +1,58 @@
+/**
+ * This header file declares the functions related to assembly-time constants and integer expressions. An expression
+ * is parsed once, in the first pass, into a compact postfix bytecode. If it only uses numbers and known constants it is
+ * folded right away, otherwise it is recorded as a fixup of its statement and folded after the addresses are final.
+ */
+
+#ifndef ASM_EXPRESSION_H
+#define ASM_EXPRESSION_H
+
+#include "utils.h"
+#include "statement_structs.h"
+
+#define EXPR_INITIAL_CAPACITY 64
+#define MAX_EXPR_STACK 32
+#define MAX_EXPR_DEPTH 32
+#define MAX_EXPR_SYMBOLS 64
+#define MAX_EXPR_MAGNITUDE 32767
+#define NONLINEAR_LABEL_WEIGHT (MAX_EXPR_SYMBOLS + 1)
+
+/* Enumeration for the operations of the expression bytecode */
+typedef enum expr_op {
+    NUM_EXPR_OP, /* Push the number that follows */
+    SYMBOL_EXPR_OP, /* Push the value of the symbol whose name offset follows (a label or a constant defined later) */
+    CONST_EXPR_OP, /* Push the value of the constant expression whose start follows */
+    ADD_EXPR_OP,
+    SUB_EXPR_OP,
+    MUL_EXPR_OP,
+    DIV_EXPR_OP,
+    NEG_EXPR_OP,
+    END_EXPR_OP
+} expr_op;
+
+/* Forward declaration of the struct constant */
+typedef struct constant Constant;
+
+/* Pointer to the struct constant */
+typedef Constant *Constptr;
+
+boolean parse_expression(char *, int *, int *);
+boolean parse_sum(char **);
+boolean parse_product(char **);
+boolean parse_factor(char **);
+boolean parse_expr_symbol(char **);
+void append_expr_code(int);
+boolean has_expr_symbols(int);
+int combine_label_weights(expr_op, int, int);
+boolean evaluate_expression(int, int *, int *, int, err *);
+boolean resolve_expr_symbol(char *, int *, int *, int, err *);
+int collect_expr_symbols(int, char **, int, int);
+Constptr find_constant(char *);
+boolean define_constant(char *, char *, boolean);
+int get_fixup_count(void);
+void add_fixup(int, int);
+int get_fixup_expr(int);
+boolean fold_expressions(void);
+void free_expressions(void);
+
+#endif
@@ -11,6 +11,8 @@
 #include "utils.h"
 #include "globals.h"
 #include "symbol_structs.h"
+#include "statement_structs.h"
+#include "expression.h"
 
 /* Definition of a symbol in the symbol table (linked list) */
 struct symbol {
@@ -22,6 +24,30 @@ struct symbol {
     Symbolptr next; /* Pointer to the next symbol in the symbol table */
 };
 
+/* Definition of a statement in the statement list (linked list) */
+struct stmt {
+    int line_num; /* The line number of the statement in the extended source file */
+    char *source; /* A copy of the source line of the statement (kept only for the listing file), or NULL */
+    char label[MAX_SYMBOL_LEN + 1]; /* The symbol defined by the statement, or an empty string */
+    statement_type type; /* The type of the statement (instruction, directive) */
+    opcode op; /* The opcode of an instruction statement */
+    directive dir; /* The directive of a directive statement */
+    char src[MAX_OPERAND_LEN + 1]; /* The source operand, or an empty string */
+    char dest[MAX_OPERAND_LEN + 1]; /* The destination operand (or the symbol of .entry/.extern), or an empty string */
+    addressing_mode src_mode; /* The addressing mode of the source operand */
+    addressing_mode dest_mode; /* The addressing mode of the destination operand */
+    int src_value; /* The number of an immediate or register source operand */
+    int dest_value; /* The number of an immediate or register destination operand */
+    unsigned int address; /* The offset of the statement in the code or data segment */
+    int word_count; /* The number of words the statement occupies in its segment */
+    int fixup_start; /* The index of the first expression fixup of the statement */
+    int fixup_count; /* The number of expression fixups of the statement */
+    boolean is_removed; /* Indicates if the statement was removed by an optimization pass */
+    boolean is_referenced; /* Indicates if the statement can be reached or referenced by the program */
+    Stmtptr alias; /* The data statement whose words a removed data statement shares, or NULL */
+    Stmtptr next; /* Pointer to the next statement in the statement list */
+};
+
 /**
  * Processes the source file and performs the first pass of the assembly process.
  *
@@ -30,18 +56,21 @@ struct symbol {
  * @return True if there were errors during processing, False otherwise.
  *
  * @remarks The function uses the global variables 'ic' (instruction counter), 'dc' (data counter),
- *          'line_num' (current line number), and 'symbol_table' (global symbol table) to keep track of the processing state.
+ *          'line_num' (current line number), 'symbol_table' (global symbol table) and 'stmt_table' (global statement table)
+ *          to keep track of the processing state.
  */
 boolean first_process(char *source_filename) {
     char *modified_filename_macro;
     char line[MAX_LINE_LEN]; /* Buffer to store each line of the source file */
     FILE *extended_src_fd;
+    int extended_offset = 0; /* The offset of the next line in the extended source in memory */
     boolean was_error;
 
     ic = 0;
     dc = 0;
     line_num = 1;
     symbol_table = NULL;
+    stmt_table = NULL;
     is_entry_exists = FALSE;
     is_extern_exists = FALSE;
 
@@ -50,15 +79,16 @@ boolean first_process(char *source_filename) {
     /* Generate a modified filename with a macro extension */
     modified_filename_macro = generate_new_filename(source_filename, FILE_MACRO);
 
-    extended_src_fd = fopen(modified_filename_macro, "r");
-    if (extended_src_fd == NULL) {
+    /* When the program is assembled in memory, the pre-processor kept the extended source in memory */
+    extended_src_fd = is_memory_mode ? NULL : fopen(modified_filename_macro, "r");
+    if (extended_src_fd == NULL && !is_memory_mode) {
         print_error(CANNOT_OPEN_FILE);
         free(modified_filename_macro);
         return TRUE;
     }
 
     /* Read each line from the extended source file and process it */
-    while (fgets(line, MAX_LINE_LEN, extended_src_fd)) {
+    while (read_extended_line(line, MAX_LINE_LEN, extended_src_fd, &extended_offset)) {
         /* Trim leading and trailing whitespaces from the line before processing */
         trim_whitespaces(line);
         /* Check if the line should be ignored */
@@ -78,7 +108,10 @@ boolean first_process(char *source_filename) {
 
     free(modified_filename_macro);
 
-    fclose(extended_src_fd);
+    if (extended_src_fd != NULL) {
+        fclose(extended_src_fd);
+    }
+    free_extended_text();
 
     return was_error;
 }
@@ -92,13 +125,16 @@ boolean first_process(char *source_filename) {
  *
  * @remarks The function parses a line of assembly code and performs the necessary operations based on the tokens found in the line.
  *          It uses the global variables 'ic' and 'dc' to track the instruction counter and data counter, respectively.
- *          The function also uses the global variable 'symbol_table' to store and manage symbols encountered during parsing.
+ *          The function also uses the global variable 'symbol_table' to store and manage symbols encountered during parsing,
+ *          and the global variable 'stmt_table' to record the parsed statement.
  */
 boolean parse_line(char *line) {
     opcode op_val = NONE_OP;
     directive dir_val = NONE_DIR;
     boolean is_symbol_exists = FALSE;
     Symbolptr current_symbol =  NULL;
+    Stmt current_stmt; /* The statement described by the line */
+    char *source_line = line; /* The whole line, kept for the listing file */
     char current_token[MAX_LINE_LEN];
 
     /* Extract the next token from the line, which could be a symbol or an operation/directive */
@@ -124,6 +160,8 @@ boolean parse_line(char *line) {
 
     /* If the token is an operation, process it */
     if ((op_val = find_operation(current_token)) != NONE_OP) {
+        init_stmt(&current_stmt, INSTRUCTION);
+        current_stmt.address = ic;
         if (is_symbol_exists) {
             current_symbol->type = INSTRUCTION;
             current_symbol->address = ic;
@@ -146,7 +184,7 @@ boolean parse_line(char *line) {
             return FALSE;
         }
         /* Process the operation */
-        if (!process_operation(op_val, line)) {
+        if (!process_operation(op_val, line, &current_stmt)) {
             if (is_symbol_exists) {
                 delete_symbol(&symbol_table, current_symbol->name);
                 is_symbol_exists = FALSE;
@@ -155,9 +193,11 @@ boolean parse_line(char *line) {
         }
     /* If the token is a directive, process it */
     } else if ((dir_val = find_directive(current_token)) != NONE_DIR) {
+        init_stmt(&current_stmt, DIRECTIVE);
+        current_stmt.address = dc;
         if (is_symbol_exists) {
-            /* Skip symbol creation before encountering .entry/.extern directive */
-            if (dir_val == EXTERN || dir_val == ENTRY) {
+            /* Skip symbol creation before encountering .entry/.extern/.equ/.set directive */
+            if (dir_val == EXTERN || dir_val == ENTRY || dir_val == EQU || dir_val == SET) {
                 delete_symbol(&symbol_table, current_symbol->name);
                 is_symbol_exists = FALSE;
             } else {
@@ -183,13 +223,15 @@ boolean parse_line(char *line) {
             return FALSE;
         }
         /* Process the directive */
-        if (!process_directive(dir_val, line)) {
+        if (!process_directive(dir_val, line, &current_stmt)) {
             if (is_symbol_exists) {
                 delete_symbol(&symbol_table, current_symbol->name);
                 is_symbol_exists = FALSE;
             }
             return FALSE;
         }
+        current_stmt.word_count = dc - current_stmt.address;
+        current_stmt.fixup_count = get_fixup_count() - current_stmt.fixup_start;
     /* If the token is neither an operation nor a directive, it is undefined */
     } else {
         if (is_symbol_exists) {
@@ -200,6 +242,15 @@ boolean parse_line(char *line) {
         return FALSE;
     }
 
+    /* Record the statement together with the symbol it defines (and its line if a listing file is written) */
+    if (is_symbol_exists) {
+        strcpy(current_stmt.label, current_symbol->name);
+    }
+    if (is_listing_enabled) {
+        set_stmt_source(&current_stmt, source_line);
+    }
+    add_stmt_to_list(&stmt_table, &current_stmt);
+
     return TRUE;
 }
 
@@ -208,16 +259,14 @@ boolean parse_line(char *line) {
  *
  * @param op_type   The opcode related to the operation name.
  * @param line      The string representation of a single line of assembly code containing the operation.
+ * @param stmt      The statement to fill with the operation's opcode, operands and addressing modes.
  *
  * @return True if the operation is successfully processed, False otherwise.
- *
- * @remarks The function uses the global variable 'ic' (instruction counter) to update the instruction counter based on the additional word count.
  */
-boolean process_operation(opcode op_type, char *line) {
+boolean process_operation(opcode op_type, char *line, Stmtptr stmt) {
     boolean has_first_operand = FALSE, has_second_operand = FALSE;
-    addressing_mode first_operand_addr_mode = NONE_ADDR, second_operand_addr_mode = NONE_ADDR;
-    char first_operand[MAX_OPERAND_LEN]; /* Represents the source operand or the destination operand (if no second operand is applicable). */
-    char second_operand[MAX_OPERAND_LEN]; /* Represents the destination operand if it exists. */
+    char first_operand[MAX_LINE_LEN]; /* Represents the source operand or the destination operand (if no second operand is applicable). */
+    char second_operand[MAX_LINE_LEN]; /* Represents the destination operand if it exists. */
     int commas_cnt = count_commas(line);
 
     if (commas_cnt > OP_MAX_NUM_COMMAS) {
@@ -270,14 +319,43 @@ boolean process_operation(opcode op_type, char *line) {
         return FALSE;
     }
 
+    /* Validate, encode and record the operation */
+    return add_operation(op_type, has_first_operand ? first_operand : NULL, has_second_operand ? second_operand : NULL, stmt);
+}
+
+/**
+ * Validates the operands of an operation, appends its first word to the code segment and records it in a statement.
+ *
+ * @param op_type           The opcode of the operation.
+ * @param first_operand     The source operand, or the destination operand if there is a single operand (NULL if none).
+ * @param second_operand    The destination operand if there are two operands (NULL otherwise).
+ * @param stmt              The statement to fill with the operation's opcode, operands and addressing modes.
+ *
+ * @return True if the operation is valid, False otherwise.
+ *
+ * @remarks The function uses the global variable 'ic' (instruction counter) to update the instruction counter based on the additional word count.
+ *          It is shared by the text front end (process_operation) and the builder API (emit_op).
+ */
+boolean add_operation(opcode op_type, char *first_operand, char *second_operand, Stmtptr stmt) {
+    boolean has_first_operand = first_operand != NULL, has_second_operand = second_operand != NULL;
+    addressing_mode first_operand_addr_mode = NONE_ADDR, second_operand_addr_mode = NONE_ADDR;
+    int first_operand_value = 0, second_operand_value = 0; /* The numbers of immediate or register operands */
+    int first_operand_expr = -1, second_operand_expr = -1; /* The expressions of immediate operands folded later */
+
+    if ((has_first_operand && strlen(first_operand) > MAX_OPERAND_LEN) || (has_second_operand && strlen(second_operand) > MAX_OPERAND_LEN)) {
+        /* An operand that does not fit in the statement cannot be valid */
+        print_error(OP_INVALID_ADDR_MODE);
+        return FALSE;
+    }
+
     if (has_first_operand) {
         /* Determine the addressing mode of the first operand */
-        first_operand_addr_mode = detect_addr_mode(first_operand);
+        first_operand_addr_mode = detect_addr_mode(first_operand, &first_operand_value, &first_operand_expr);
     }
 
     if (has_second_operand) {
         /* Determine the addressing mode of the second operand */
-        second_operand_addr_mode = detect_addr_mode(second_operand);
+        second_operand_addr_mode = detect_addr_mode(second_operand, &second_operand_value, &second_operand_expr);
     }
 
     if ((has_first_operand && first_operand_addr_mode == NONE_ADDR) || (has_second_operand && second_operand_addr_mode == NONE_ADDR)) {
@@ -298,12 +376,38 @@ boolean process_operation(opcode op_type, char *line) {
         return FALSE;
     }
 
+    /* Record the expressions that are folded once the symbol addresses are final, a single operand is the destination */
+    if (first_operand_expr != -1) {
+        add_fixup(has_second_operand ? 0 : 1, first_operand_expr);
+    }
+
+    if (second_operand_expr != -1) {
+        add_fixup(1, second_operand_expr);
+    }
+
     /* Encode the operation word and append it to the code segment */
     append_word_to_code(encode_first_op_word(op_type, has_first_operand, has_second_operand, first_operand_addr_mode, second_operand_addr_mode));
 
     /* Update the instruction counter (IC) based on the additional word count */
     ic += get_additional_word_count(has_first_operand, has_second_operand, first_operand_addr_mode, second_operand_addr_mode);
 
+    /* Record the operation in the statement, a single operand is always the destination operand */
+    stmt->op = op_type;
+    if (has_second_operand) {
+        strcpy(stmt->src, first_operand);
+        stmt->src_mode = first_operand_addr_mode;
+        stmt->src_value = first_operand_value;
+        strcpy(stmt->dest, second_operand);
+        stmt->dest_mode = second_operand_addr_mode;
+        stmt->dest_value = second_operand_value;
+    } else if (has_first_operand) {
+        strcpy(stmt->dest, first_operand);
+        stmt->dest_mode = first_operand_addr_mode;
+        stmt->dest_value = first_operand_value;
+    }
+    stmt->word_count = ic - stmt->address;
+    stmt->fixup_count = get_fixup_count() - stmt->fixup_start;
+
     return TRUE;
 }
 
@@ -312,24 +416,39 @@ boolean process_operation(opcode op_type, char *line) {
  *
  * @param dir_type  The type of the directive to process.
  * @param line      The line of assembly code containing the directive and its parameters.
+ * @param stmt      The statement to fill with the directive type (and the symbol of an ENTRY/EXTERN directive).
  *
  * @return TRUE if the directive was processed successfully, FALSE otherwise.
  */
-boolean process_directive(directive dir_type, char *line) {
+boolean process_directive(directive dir_type, char *line, Stmtptr stmt) {
     if (is_empty(line)) {
         print_error(DIR_MISSING_PARAMS);
         return FALSE;
     }
 
+    stmt->dir = dir_type;
+
     switch (dir_type) {
         case DATA:
             return process_data_dir(line);
         case STRING:
             return process_string_dir(line);
+        /* The symbol is copied only once it is validated, which bounds its length by the size of the operand */
         case ENTRY:
-            return process_entry_dir(line);
+            if (!process_entry_dir(line)) {
+                return FALSE;
+            }
+            copy_next_token(stmt->dest, line, "\t ");
+            return TRUE;
         case EXTERN:
-            return process_extern_dir(line);
+            if (!process_extern_dir(line)) {
+                return FALSE;
+            }
+            copy_next_token(stmt->dest, line, "\t ");
+            return TRUE;
+        case EQU:
+        case SET:
+            return process_constant_dir(line, dir_type == SET);
         default:
             break;
     }
@@ -345,15 +464,21 @@ boolean process_directive(directive dir_type, char *line) {
  * @return TRUE if the DATA directive was processed successfully, FALSE otherwise.
  */
 boolean process_data_dir(char *line) {
-    char param[MAX_OPERAND_LEN];
+    char param[MAX_LINE_LEN]; /* A token of the line, which can be longer than a valid param */
+    int start_dc = dc; /* The data counter at the first param, to find the word of each param */
+    int value;
+    int expr_start;
 
     /* Process each param until the line is empty */
     while (!is_empty(line)) {
         /* Extract the next param */
         copy_next_token(param, line, ",\t ");
 
-        /* Check if the param is a valid number */
-        if (!is_number(param)) {
+        /* Check if the param is a valid number or expression */
+        if (is_number(param)) {
+            value = atoi(param);
+            expr_start = -1;
+        } else if (!parse_expression(param, &value, &expr_start)) {
             print_error(DATA_NOT_NUM);
             return FALSE;
         }
@@ -373,8 +498,13 @@ boolean process_data_dir(char *line) {
             return FALSE;
         }
 
-        /* Convert the param to a number and append it to the data segment */
-        append_number_to_data(atoi(param));
+        /* An expression that depends on the symbol addresses is stored in its word once it is folded */
+        if (expr_start != -1) {
+            add_fixup(dc - start_dc, expr_start);
+        }
+
+        /* Append the number to the data segment */
+        append_number_to_data(value);
 
         /* Move to the next character in the line */
         if (!is_empty(line)) {
@@ -393,7 +523,7 @@ boolean process_data_dir(char *line) {
  * @return TRUE if the STRING directive was processed successfully, FALSE otherwise.
  */
 boolean process_string_dir(char *line) {
-    char param[MAX_OPERAND_LEN];
+    char param[MAX_LINE_LEN]; /* A token of the line, which can be longer than a valid param */
     int param_len;
     int i;
 
@@ -430,7 +560,7 @@ boolean process_string_dir(char *line) {
  * @return TRUE if the ENTRY directive was processed successfully, FALSE otherwise.
  */
 boolean process_entry_dir(char *line) {
-    char param[MAX_SYMBOL_LEN];
+    char param[MAX_LINE_LEN]; /* A token of the line, which can be longer than a valid symbol */
 
     /* Extract the symbol name from the line */
     copy_next_token(param, line, "\t ");
@@ -469,7 +599,7 @@ boolean process_entry_dir(char *line) {
  * @remarks The function uses the global variable 'symbol_table' to store and manage symbols encountered during processing.
  */
 boolean process_extern_dir(char *line) {
-    char param[MAX_SYMBOL_LEN];
+    char param[MAX_LINE_LEN]; /* A token of the line, which can be longer than a valid symbol */
 
     /* Extract the symbol name from the line */
     copy_next_token(param, line, "\t ");
@@ -502,6 +632,54 @@ boolean process_extern_dir(char *line) {
     return TRUE;
 }
 
+/**
+ * Processes the EQU and SET directives by extracting the constant name and its expression and defining the constant.
+ *
+ * @param line      The line of assembly code containing the directive parameters (name, comma, expression).
+ * @param is_set    Indicates if the directive is SET (TRUE) or EQU (FALSE).
+ *
+ * @return TRUE if the directive was processed successfully, FALSE otherwise.
+ */
+boolean process_constant_dir(char *line, boolean is_set) {
+    char name[MAX_LINE_LEN];
+    char param[MAX_LINE_LEN];
+
+    /* Extract and validate the constant name */
+    copy_next_token(name, line, ",\t ");
+    if (is_empty(name)) {
+        print_error(CONST_MISSING_PARAMS);
+        return FALSE;
+    }
+
+    if (!is_symbol(name, FALSE)) {
+        return FALSE;
+    }
+
+    /* A comma separates the name from the expression */
+    line = extract_remaining_seq(line, ",\t ");
+    if (line[0] != ',') {
+        print_error(CONST_MISSING_PARAMS);
+        return FALSE;
+    }
+    line++;
+
+    /* Extract the expression */
+    copy_next_token(param, line, "\t ");
+    if (is_empty(param)) {
+        print_error(CONST_MISSING_PARAMS);
+        return FALSE;
+    }
+
+    /* Check for extraneous text after the expression */
+    line = extract_remaining_seq(line, "\t ");
+    if (!is_empty(line)) {
+        print_error(CONST_EXTRANEOUS_TEXT);
+        return FALSE;
+    }
+
+    return define_constant(name, param, is_set);
+}
+
 /**
  * Checks if the given sequence represents a valid number.
  *
@@ -564,25 +742,78 @@ boolean is_string(char *str) {
 
 /**
  * Detects the addressing mode of the given operand.
+ * The operand is classified by its first character (a digit or a sign, '@' or a letter) and validated in a single scan.
+ * A constant or an expression is an immediate operand.
  *
- * @param operand The operand to detect the addressing mode for.
+ * @param operand       The operand to detect the addressing mode for.
+ * @param value         Where to store the number of an immediate operand or the register number of a register operand.
+ * @param expr_start    Where to store the start of the expression of an immediate operand that depends on the symbol
+ *                      addresses, or -1.
  *
  * @return The addressing mode of the operand.
  */
-addressing_mode detect_addr_mode(char *operand) {
-    /* If the operand is a number, it has immediate addressing mode */
-    if (is_number(operand)) {
+addressing_mode detect_addr_mode(char *operand, int *value, int *expr_start) {
+    unsigned int number = 0;
+    boolean is_negative = FALSE;
+    int i = 0;
+
+    *expr_start = -1;
+
+    switch (operand[0]) {
+        /* A register operand is '@', 'r' and a register index */
+        case '@':
+            if (operand[1] == 'r' && operand[2] >= '0' + MIN_REG_INDEX && operand[2] <= '0' + MAX_REG_INDEX && operand[3] == '\0') {
+                *value = operand[2] - '0';
+                return REG_DIRECT_ADDR;
+            }
+            break;
+
+        /* An immediate operand is an optional sign followed by digits */
+        case '-':
+        case '+':
+            is_negative = operand[0] == '-';
+            i++;
+            /* Fall through */
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+            if (!isdigit(operand[i])) {
+                break;
+            }
+            while (isdigit(operand[i])) {
+                number = number * 10 + (operand[i] - '0');
+                i++;
+            }
+            if (operand[i] == '\0') {
+                *value = is_negative ? -(int)number : (int)number;
+                return IMMEDIATE_ADDR;
+            }
+            break;
+
+        /* A direct operand is a symbol: a letter followed by letters and digits, which is not a reserved word */
+        default:
+            if (!isalpha(operand[0])) {
+                break;
+            }
+            while (isalnum(operand[i])) {
+                i++;
+            }
+            if (operand[i] == '\0' && i <= MAX_SYMBOL_LEN && classify_word(operand, NULL) == IDENTIFIER_WORD) {
+                /* A constant defined earlier stands for its value */
+                if (find_constant(operand) != NULL) {
+                    return parse_expression(operand, value, expr_start) ? IMMEDIATE_ADDR : NONE_ADDR;
+                }
+                return DIRECT_ADDR;
+            }
+            break;
+    }
+
+    /* Any other operand may be an expression, whose value is an immediate number */
+    if (parse_expression(operand, value, expr_start)) {
         return IMMEDIATE_ADDR;
-    /* If the operand is a register, it has register direct addressing mode */
-    } else if (is_register(operand)) {
-        return REG_DIRECT_ADDR;
-    /* If the operand is a valid symbol without a colon, it has direct addressing mode */
-    } else if (is_symbol(operand, FALSE)) {
-        return DIRECT_ADDR;
-    /* If none of the above conditions match, the addressing mode is not recognized */
-    } else {
-        return NONE_ADDR;
     }
+
+    /* The operand is not valid, validate it as a symbol to report the reason */
+    return is_symbol(operand, FALSE) ? DIRECT_ADDR : NONE_ADDR;
 }
 
 /**
@@ -9,6 +9,7 @@
 #define ASM_FIRST_PASS_H
 
 #include "utils.h"
+#include "statement_structs.h"
 
 #define DEFAULT_ADDR 0
 #define OP_MAX_NUM_COMMAS 1
@@ -17,15 +18,17 @@
 
 boolean first_process(char *);
 boolean parse_line(char *);
-boolean process_operation(opcode, char *);
-boolean process_directive(directive, char *);
+boolean process_operation(opcode, char *, Stmtptr);
+boolean add_operation(opcode, char *, char *, Stmtptr);
+boolean process_directive(directive, char *, Stmtptr);
 boolean process_data_dir(char *);
 boolean process_string_dir(char *);
 boolean process_entry_dir(char *);
 boolean process_extern_dir(char *);
+boolean process_constant_dir(char *, boolean);
 boolean is_number(char *);
 boolean is_string(char *);
-addressing_mode detect_addr_mode(char *);
+addressing_mode detect_addr_mode(char *, int *, int *);
 boolean is_valid_operand_count(opcode, boolean, boolean);
 boolean is_valid_mode_combination(opcode, addressing_mode, addressing_mode);
 void append_number_to_data(int);
@@ -0,0 +1,39 @@
+/**
+ * This file contains the definitions of the global variables declared in globals.h. They are part of the asm_core
+ * library, so the assembler and the programs that use the builder API share them without defining them again.
+ */
+
+#include <stdio.h>
+#include "utils.h"
+#include "globals.h"
+#include "symbol_structs.h"
+#include "statement_structs.h"
+
+boolean is_entry_exists; /* Flag to track if an entry exists in the code */
+boolean is_extern_exists; /* Flag to track if an extern declaration exists in the code */
+boolean is_peephole_enabled; /* Flag to enable the peephole optimization pass */
+boolean is_elimination_enabled; /* Flag to enable the unreachable code and unused data elimination pass */
+boolean is_dedup_enabled; /* Flag to enable the data deduplication pass */
+boolean is_listing_enabled; /* Flag to enable the listing file */
+boolean is_size_report_enabled; /* Flag to enable the size report */
+boolean is_cycle_report_enabled; /* Flag to enable the cycle estimate */
+boolean is_call_profile_enabled; /* Flag to enable the call profile */
+boolean is_memory_mode; /* Flag to assemble the programs in memory */
+boolean is_verify_mode; /* Flag to verify images instead of assembling sources */
+boolean is_diff_mode; /* Flag to diff pairs of images instead of assembling sources */
+int worker_count; /* The number of worker processes of the coordinator, or 0 to assemble in this process */
+int shard_timeout; /* The seconds a worker process may take on a shard, or 0 for the default */
+long memory_budget; /* The memory budget of the worker processes in bytes, or 0 for no limit */
+char *manifest_path; /* The manifest file listing more file names, or NULL if there is none */
+char *cache_path; /* The socket of the build cache daemon, or NULL to assemble without it */
+char *cache_daemon_path; /* The socket the build cache daemon listens on, or NULL to assemble instead */
+FILE *listing_fd; /* The listing file written during the second pass */
+unsigned int code[MEM_SIZE]; /* Array to store the machine code instructions */
+unsigned int data[MEM_SIZE]; /* Array to store the data values */
+int ic; /* Instruction Counter */
+int dc; /* Data Counter */
+int line_num; /* Line number in the input file */
+Symbolptr symbol_table; /* Pointer to the symbol table */
+Extptr ext_table; /* Pointer to the extern table */
+Stmtptr stmt_table; /* Pointer to the statement table */
+Defptr cmd_define_table; /* Pointer to the table of the symbols defined on the command line */
\ No newline at end of file
@@ -8,6 +8,8 @@
 #define ASM_GLOBALS_H
 
 #include "symbol_structs.h"
+#include "statement_structs.h"
+#include "pre_asm.h"
 
 /* A flag that indicates whether there was at least one entry directive in the program */
 extern boolean is_entry_exists;
@@ -15,6 +17,60 @@ extern boolean is_entry_exists;
 /* A flag that indicates whether there was at least one extern directive in the program */
 extern boolean is_extern_exists;
 
+/* A flag that indicates whether the peephole optimization pass should run between the first and second passes */
+extern boolean is_peephole_enabled;
+
+/* A flag that indicates whether the unreachable code and unused data elimination pass should run between the passes */
+extern boolean is_elimination_enabled;
+
+/* A flag that indicates whether the data deduplication pass should run between the first and second passes */
+extern boolean is_dedup_enabled;
+
+/* A flag that indicates whether a listing file should be written during the second pass */
+extern boolean is_listing_enabled;
+
+/* A flag that indicates whether a size report should be printed after the optimization passes */
+extern boolean is_size_report_enabled;
+
+/* A flag that indicates whether a cycle estimate of the routines should be printed after the optimization passes */
+extern boolean is_cycle_report_enabled;
+
+/* A flag that indicates whether a call profile and a folded stacks file should be written after the optimization passes */
+extern boolean is_call_profile_enabled;
+
+/* A flag that indicates whether the programs are assembled in memory, without the .am, .ob, .ent and .ext files */
+extern boolean is_memory_mode;
+
+/* A flag that indicates whether the files given on the command line are images to verify instead of sources */
+extern boolean is_verify_mode;
+
+/* A flag that indicates whether the files given on the command line are pairs of images to diff instead of sources */
+extern boolean is_diff_mode;
+
+/* The number of worker processes the source files are sharded over, or 0 to assemble them in this process */
+extern int worker_count;
+
+/* The seconds a worker process may take on a shard before it is stopped and the shard retried, or 0 for the default */
+extern int shard_timeout;
+
+/* The memory the worker processes may take for the files they assemble at once, in bytes, or 0 for no limit */
+extern long memory_budget;
+
+/* The manifest file listing more file names, one per line, or NULL if there is none */
+extern char *manifest_path;
+
+/* The socket of the build cache daemon the source files are assembled through, or NULL to assemble without it */
+extern char *cache_path;
+
+/* The socket (and optional capacity) the build cache daemon listens on, or NULL to assemble instead */
+extern char *cache_daemon_path;
+
+/* The listing file written during the second pass, or NULL if no listing file is written */
+extern FILE *listing_fd;
+
+/* The symbols defined with -D on the command line, which apply to the ifdef directives of all the files */
+extern Defptr cmd_define_table;
+
 /* Array to store the assembled code instructions */
 extern unsigned int code[];
 
@@ -37,4 +93,8 @@ extern Symbolptr symbol_table;
 /* Ext Table is a data structure used to store information about external symbols encountered in the assembly code */
 extern Extptr ext_table;
 
+/* Statement Table is the list of statements parsed during the first pass, in source order */
+/* The optimization passes and the second pass work on it instead of parsing the source file again */
+extern Stmtptr stmt_table;
+
 #endif
\ No newline at end of file
@@ -1,25 +1,160 @@
 /**
  * This file contains the main function and related code that serves as the entry point for the software project.
- * It performs various tasks, including command-line argument processing, two passes of processing on each argument,
- * creating output files, and freeing allocated memory.
+ * It performs various tasks, including command-line argument processing, two passes of processing on each argument
+ * (with the optional optimization passes in between), creating output files, and freeing allocated memory.
  */
 
+#include <stdlib.h>
+#include <string.h>
 #include "utils.h"
+#include "globals.h"
 #include "pre_asm.h"
-#include "first_pass.h"
-#include "second_pass.h"
-#include "output_files.h"
+#include "assembler.h"
+#include "verifier.h"
+#include "object_diff.h"
+#include "coordinator.h"
+#include "build_cache.h"
 #include "symbol_structs.h"
+#include "statement_structs.h"
 
-boolean is_entry_exists; /* Flag to track if an entry exists in the code */
-boolean is_extern_exists; /* Flag to track if an extern declaration exists in the code */
-unsigned int code[MEM_SIZE]; /* Array to store the machine code instructions */
-unsigned int data[MEM_SIZE]; /* Array to store the data values */
-int ic; /* Instruction Counter */
-int dc; /* Data Counter */
-int line_num; /* Line number in the input file */
-Symbolptr symbol_table; /* Pointer to the symbol table */
-Extptr ext_table; /* Pointer to the extern table */
+/**
+ * Processes a command-line option.
+ *
+ * @param option The command-line argument holding the option (starting with '-').
+ *
+ * @return TRUE if the option is known, FALSE otherwise.
+ */
+boolean process_option(char *option) {
+    if (strcmp(option, "-O") == 0) {
+        is_peephole_enabled = TRUE;
+    } else if (strcmp(option, "-U") == 0) {
+        is_elimination_enabled = TRUE;
+    } else if (strcmp(option, "-M") == 0) {
+        is_dedup_enabled = TRUE;
+    } else if (strcmp(option, "-L") == 0) {
+        is_listing_enabled = TRUE;
+    } else if (strcmp(option, "-S") == 0) {
+        is_size_report_enabled = TRUE;
+    } else if (strcmp(option, "-C") == 0) {
+        is_cycle_report_enabled = TRUE;
+    } else if (strcmp(option, "-F") == 0) {
+        is_call_profile_enabled = TRUE;
+    } else if (strcmp(option, "-N") == 0) {
+        is_memory_mode = TRUE;
+    } else if (strcmp(option, "-V") == 0) {
+        is_verify_mode = TRUE;
+    } else if (strcmp(option, "-X") == 0) {
+        is_diff_mode = TRUE;
+    } else if (strncmp(option, "-P", 2) == 0 && atoi(option + 2) >= 1 && atoi(option + 2) <= MAX_WORKERS) {
+        worker_count = atoi(option + 2);
+    } else if (strncmp(option, "-T", 2) == 0 && atoi(option + 2) >= 1 && atoi(option + 2) <= MAX_SHARD_TIMEOUT) {
+        shard_timeout = atoi(option + 2);
+    } else if (strncmp(option, "-B", 2) == 0 && atol(option + 2) >= 1 && atol(option + 2) <= MAX_MEMORY_BUDGET_MB) {
+        memory_budget = atol(option + 2) * 1024 * 1024;
+    } else if (strncmp(option, "-I", 2) == 0 && option[2] != '\0') {
+        manifest_path = option + 2;
+    } else if (strncmp(option, "-K", 2) == 0 && option[2] != '\0') {
+        cache_path = option + 2;
+    } else if (strncmp(option, "-Y", 2) == 0 && option[2] != '\0') {
+        cache_daemon_path = option + 2;
+    } else if (strncmp(option, "-D", 2) == 0 && option[2] != '\0' && strlen(option + 2) <= MAX_MCR_LEN) {
+        add_define(&cmd_define_table, option + 2);
+    } else {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * Collects the file names of the command line followed by the file names of the manifest file. Each line of the
+ * manifest holds one file name, and empty lines and lines starting with ';' are skipped.
+ *
+ * @param argc          The number of command-line arguments.
+ * @param argv          The command-line arguments.
+ * @param file_count    Receives the number of file names.
+ *
+ * @return The array of the file names (the manifest names are allocated), or NULL if the manifest cannot be read.
+ */
+char **collect_files(int argc, char *argv[], int *file_count) {
+    char **files;
+    char **new_files;
+    char line[MAX_LINE_LEN];
+    FILE *manifest_fd = NULL;
+    int capacity = argc;
+    int i;
+
+    *file_count = 0;
+
+    if (manifest_path != NULL) {
+        manifest_fd = fopen(manifest_path, "r");
+        if (manifest_fd == NULL) {
+            print_error(CANNOT_OPEN_FILE);
+            return NULL;
+        }
+    }
+
+    files = (char **)malloc(capacity * sizeof(char *));
+    if (files == NULL) {
+        print_error(MEM_ALLOC_FAILED);
+        exit(1);
+    }
+
+    for (i = 1; i < argc; i++) {
+        if (argv[i][0] != '-') {
+            files[(*file_count)++] = argv[i];
+        }
+    }
+
+    if (manifest_fd == NULL) {
+        return files;
+    }
+
+    while (fgets(line, MAX_LINE_LEN, manifest_fd)) {
+        trim_whitespaces(line);
+        if (line[0] == '\0' || line[0] == ';') {
+            continue;
+        }
+
+        /* Double the capacity of the file names array when it is full */
+        if (*file_count == capacity) {
+            capacity *= 2;
+            new_files = (char **)realloc(files, capacity * sizeof(char *));
+            if (new_files == NULL) {
+                print_error(MEM_REALLOC_FAILED);
+                exit(1);
+            }
+            files = new_files;
+        }
+
+        files[*file_count] = (char *)malloc((strlen(line) + 1) * sizeof(char));
+        if (files[*file_count] == NULL) {
+            print_error(MEM_ALLOC_FAILED);
+            exit(1);
+        }
+        strcpy(files[(*file_count)++], line);
+    }
+
+    fclose(manifest_fd);
+
+    return files;
+}
+
+/**
+ * Frees the file names collected from the command line and the manifest file.
+ *
+ * @param files         The array of the file names.
+ * @param command_count The number of file names given on the command line, which come first and are not allocated.
+ * @param file_count    The number of file names.
+ */
+void free_files(char **files, int command_count, int file_count) {
+    int i;
+
+    for (i = command_count; i < file_count; i++) {
+        free(files[i]);
+    }
+    free(files);
+}
 
 /**
  * The main entry point of the program.
@@ -30,49 +165,100 @@ Extptr ext_table; /* Pointer to the extern table */
  * @return An integer indicating the exit status of the program.
  */
 int main(int argc, char *argv[]) {
+    char **files;
     int i;
+    int command_count = 0;
+    int file_count;
+
+    /* Process the command-line options, which apply to all the files */
+    for (i = 1; i < argc; i++) {
+        if (argv[i][0] == '-') {
+            if (!process_option(argv[i])) {
+                print_error(UNKNOWN_OPTION);
+                free_defines(&cmd_define_table);
+                return 1;
+            }
+        } else {
+            command_count++;
+        }
+    }
+
+    /* The memory budget and the shard timeout limit the worker processes, and would otherwise be silently ignored */
+    if ((memory_budget > 0 || shard_timeout > 0) && worker_count == 0) {
+        print_error(LIMIT_WITHOUT_WORKERS);
+        free_defines(&cmd_define_table);
+        return 1;
+    }
 
-    /* Check if the number of command-line arguments is less than 2 */
-    if (argc < 2) {
+    /* Run the build cache daemon instead of assembling */
+    if (cache_daemon_path != NULL) {
+        run_cache_daemon(cache_daemon_path);
+        free_defines(&cmd_define_table);
+        return 0;
+    }
+
+    /* The files of the manifest follow the files of the command line */
+    files = collect_files(argc, argv, &file_count);
+    if (files == NULL) {
+        free_defines(&cmd_define_table);
+        return 1;
+    }
+
+    /* Without file names, the build cache option prints the metrics of the daemon */
+    if (cache_path != NULL && file_count == 0) {
+        print_cache_stats();
+        free_files(files, command_count, file_count);
+        free_defines(&cmd_define_table);
+        return 0;
+    }
+
+    /* Check if at least one file name was given, and that the images to diff come in pairs */
+    if (file_count < 1 || (is_diff_mode && file_count % 2 != 0)) {
         print_error(NOT_ENOUGH_PARAMS);
+        free_files(files, command_count, file_count);
+        free_defines(&cmd_define_table);
         return 1;
     }
 
-    /* Iterate over the command-line arguments */
-    for (i = 1; i < argc; i++) {
-        boolean first_success = TRUE;
-        boolean second_success = TRUE;
+    /* The options are part of the keys of the build cache */
+    if (cache_path != NULL) {
+        build_option_key(argc, argv);
+    }
 
-        /* Pre-process the current argument */
-        if (!(pre_process(argv[i]))) {
-            print_error(MCR_EXP_FAILED);
-            continue;
-        }
+    /* Shard the source files over the worker processes */
+    if (worker_count > 0 && !is_verify_mode && !is_diff_mode) {
+        run_coordinator(file_count, files);
+        free_files(files, command_count, file_count);
+        free_defines(&cmd_define_table);
+        return 0;
+    }
 
-        /* Perform the first processing pass on the current argument */
-        if (first_process(argv[i])) {
-            print_error(FIRST_PASS_FAILED);
-            first_success = FALSE;
+    /* Iterate over the file names */
+    for (i = 0; i < file_count; i++) {
+        /* Verify the image of the current file instead of assembling it */
+        if (is_verify_mode) {
+            verify_object(files[i]);
+            continue;
         }
 
-        /* Perform the second processing pass on the current argument */
-        if (second_process(argv[i])) {
-            print_error(SECOND_PASS_FAILED);
-            second_success = FALSE;
+        /* Diff the image of the current file against the image of the next file */
+        if (is_diff_mode) {
+            diff_images(files[i], files[i + 1]);
+            i++;
             continue;
         }
 
-        /* Only if all passes succeeded write the .ob, .ent, and .ext output files for the current argument */
-        if (first_success && second_success) {
-            create_output_files(argv[i]);
+        /* Assemble the current file, through the build cache if there is one */
+        if (cache_path != NULL) {
+            assemble_cached(files[i]);
+        } else {
+            assemble_source(files[i]);
         }
-
-        /* Free the memory used by the symbol table */
-        free_symbol(&symbol_table);
-
-        /* Free the memory used by the extern table */
-        free_ext(&ext_table);
     }
 
+    /* Free the memory used by the file names and the table of the symbols defined on the command line */
+    free_files(files, command_count, file_count);
+    free_defines(&cmd_define_table);
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,527 @@
+/**
+ * This file contains the implementation of the object diff. Each image is split into regions, the word runs from
+ * each entry symbol to the next one in its segment, and the addresses in relocatable operand words are rewritten as
+ * their region and offset, so a run that only moved compares equal. Regions with the same name and the same hash are
+ * unchanged; for the others, the instructions (or data words) are aligned by their longest common subsequence and
+ * reported as changed, inserted or removed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "object_diff.h"
+#include "utils.h"
+#include "globals.h"
+#include "first_pass.h"
+#include "second_pass.h"
+#include "optimizer.h"
+#include "verifier.h"
+
+/* Definition of a region of an image: the words from an entry symbol to the next one in its segment */
+struct image_region {
+    char name[MAX_SYMBOL_LEN + 1]; /* The entry symbol, or "(code)" and "(data)" for the words before the first one */
+    int start; /* The offset of the first word of the region in the image */
+    int end; /* The offset after the last word of the region */
+    boolean is_code; /* Indicates if the region is in the code segment */
+    unsigned long hash; /* The hash of the normalized words of the region */
+};
+
+/* Definition of an image loaded from an object file and its entries file */
+struct image {
+    int code_count; /* The number of words of the code segment */
+    int data_count; /* The number of words of the data segment */
+    unsigned int words[MAX_IMAGE_WORDS]; /* The words of the image, with the relocatable addresses normalized */
+    int lengths[MAX_IMAGE_WORDS]; /* The length of the instruction starting at each offset, or 0 inside one */
+    Region regions[MAX_IMAGE_WORDS + 2]; /* The regions of the image, in the order of their offsets */
+    int region_count; /* The number of regions */
+};
+
+/* Definition of an edit between the elements (instructions or data words) of two regions */
+struct edit {
+    edit_kind kind; /* The kind of the edit */
+    int old_offset; /* The offset of the element in the old image, for a changed or removed element */
+    int new_offset; /* The offset of the element in the new image, for a changed or inserted element */
+};
+
+static Image old_image; /* The image diffed from */
+static Image new_image; /* The image diffed to */
+
+/**
+ * Loads an image: its object file, the regions of its entry symbols and its decoded instructions.
+ *
+ * @param name  The name of the image (without an extension).
+ * @param image The image to load.
+ *
+ * @return TRUE if the image was loaded, FALSE otherwise.
+ */
+boolean load_image(char *name, Imageptr image) {
+    if (!read_object_file(name)) {
+        return FALSE;
+    }
+
+    image->code_count = ic;
+    image->data_count = dc;
+    memcpy(image->words, code, ic * sizeof(unsigned int));
+    memcpy(image->words + ic, data, dc * sizeof(unsigned int));
+
+    if (!read_image_symbols(name, image)) {
+        return FALSE;
+    }
+
+    normalize_image(image);
+
+    return TRUE;
+}
+
+/**
+ * Reads the entries file of an image, if there is one, and splits the segments of the image into regions.
+ *
+ * @param name  The name of the image (without an extension).
+ * @param image The image, whose segments were loaded.
+ *
+ * @return TRUE if the entries file is well formed, FALSE otherwise.
+ */
+boolean read_image_symbols(char *name, Imageptr image) {
+    char *modified_filename_entries = generate_new_filename(name, FILE_ENTRIES);
+    FILE *entries_fd = fopen(modified_filename_entries, "r");
+    char line[MAX_LINE_LEN];
+    char symbol[MAX_LINE_LEN];
+    unsigned int address;
+    int total = image->code_count + image->data_count;
+    int i;
+    boolean has_code_start = image->code_count == 0;
+    boolean has_data_start = image->data_count == 0;
+
+    free(modified_filename_entries);
+
+    image->region_count = 0;
+
+    if (entries_fd != NULL) {
+        line_num = 0;
+        while (fgets(line, MAX_LINE_LEN, entries_fd)) {
+            line_num++;
+
+            if (!parse_symbol_line(line, symbol, &address)) {
+                fclose(entries_fd);
+                return FALSE;
+            }
+
+            if (address < MEM_START || address >= (unsigned int)(MEM_START + total)) {
+                print_error(OBJ_INVALID_ENTRY_ADDRESS);
+                fclose(entries_fd);
+                return FALSE;
+            }
+
+            /* Each entry symbol names one region, and there is room for one per word besides "(code)" and "(data)" */
+            if (find_named_region(image, symbol) != NULL) {
+                print_error(OBJ_DUPLICATE_ENTRY);
+                fclose(entries_fd);
+                return FALSE;
+            }
+
+            if (image->region_count == MAX_IMAGE_WORDS) {
+                print_error(OBJ_TOO_MANY_ENTRIES);
+                fclose(entries_fd);
+                return FALSE;
+            }
+
+            strcpy(image->regions[image->region_count].name, symbol);
+            image->regions[image->region_count++].start = address - MEM_START;
+
+            has_code_start = has_code_start || address - MEM_START == 0;
+            has_data_start = has_data_start || address - MEM_START == (unsigned int)image->code_count;
+        }
+
+        fclose(entries_fd);
+    }
+
+    /* The words before the first entry symbol of each segment get a region of their own */
+    if (!has_code_start) {
+        strcpy(image->regions[image->region_count].name, "(code)");
+        image->regions[image->region_count++].start = 0;
+    }
+
+    if (!has_data_start) {
+        strcpy(image->regions[image->region_count].name, "(data)");
+        image->regions[image->region_count++].start = image->code_count;
+    }
+
+    qsort(image->regions, image->region_count, sizeof(Region), compare_regions);
+
+    /* Each region ends at the next region or at the end of its segment */
+    for (i = 0; i < image->region_count; i++) {
+        Regionptr region = &image->regions[i];
+
+        region->is_code = region->start < image->code_count;
+        region->end = i + 1 < image->region_count ? image->regions[i + 1].start : total;
+        if (region->is_code && region->end > image->code_count) {
+            region->end = image->code_count;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * Compares two regions, for sorting the regions by offset.
+ *
+ * @param first     The first region.
+ * @param second    The second region.
+ *
+ * @return A negative number if the first region starts first, a positive number if it starts last, and the order of
+ *         their names if they start at the same offset.
+ */
+int compare_regions(const void *first, const void *second) {
+    const Region *first_region = (const Region *)first;
+    const Region *second_region = (const Region *)second;
+
+    if (first_region->start != second_region->start) {
+        return first_region->start - second_region->start;
+    }
+
+    return strcmp(first_region->name, second_region->name);
+}
+
+/**
+ * Finds the region that holds a word of an image.
+ *
+ * @param image     The image.
+ * @param offset    The offset of the word in the image.
+ *
+ * @return A pointer to the region, or NULL if the offset is outside the image.
+ */
+Regionptr find_region(Imageptr image, int offset) {
+    int low = 0;
+    int high = image->region_count - 1;
+    int middle;
+    Regionptr found = NULL;
+
+    /* Find the last region that starts at or before the offset */
+    while (low <= high) {
+        middle = (low + high) / 2;
+        if (image->regions[middle].start <= offset) {
+            found = &image->regions[middle];
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+
+    return found != NULL && offset < found->end ? found : NULL;
+}
+
+/**
+ * Finds the region of an image with the given name.
+ *
+ * @param image The image.
+ * @param name  The name of the region.
+ *
+ * @return A pointer to the region, or NULL if the image has no such region.
+ */
+Regionptr find_named_region(Imageptr image, char *name) {
+    int i;
+
+    for (i = 0; i < image->region_count; i++) {
+        if (strcmp(image->regions[i].name, name) == 0) {
+            return &image->regions[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Decodes the instructions of an image, rewrites the address of each relocatable operand word as the hash of the
+ * name of its region plus its offset in the region, and hashes the words of each region.
+ *
+ * @param image The image, whose regions were built.
+ */
+void normalize_image(Imageptr image) {
+    Regionptr target;
+    addressing_mode modes[2];
+    unsigned long name_hash;
+    unsigned int word;
+    int length;
+    int next;
+    int i;
+    int j;
+    char *c;
+
+    memset(image->lengths, 0, sizeof(image->lengths));
+
+    for (i = 0; i < image->code_count; i += length) {
+        word = image->words[i];
+        length = get_instruction_length(word);
+
+        /* An invalid first word is compared as a word of its own */
+        if (length == 0 || i + length > image->code_count) {
+            image->lengths[i] = 1;
+            length = 1;
+            continue;
+        }
+        image->lengths[i] = length;
+
+        modes[0] = (addressing_mode)extract_bits(word, SRC_MODE_START_POS, SRC_MODE_END_POS);
+        modes[1] = (addressing_mode)extract_bits(word, DEST_MODE_START_POS, DEST_MODE_END_POS);
+        next = i + 1;
+
+        for (j = 0; j < 2; j++) {
+            if (modes[j] == 0) {
+                continue;
+            }
+
+            word = image->words[next];
+            if (modes[j] == DIRECT_ADDR && extract_bits(word, 0, ARE_BITS - 1) == RELOCATABLE &&
+                (target = find_region(image, (int)(word >> ARE_BITS) - MEM_START)) != NULL) {
+                name_hash = FNV_OFFSET_BASIS;
+                for (c = target->name; *c != '\0'; c++) {
+                    name_hash = (name_hash ^ (unsigned char)*c) * FNV_PRIME;
+                }
+                image->words[next] = encode_are((unsigned int)(name_hash + (word >> ARE_BITS) - MEM_START - target->start), RELOCATABLE);
+            }
+
+            /* Two register operands share a single word */
+            if (!(modes[0] == REG_DIRECT_ADDR && modes[1] == REG_DIRECT_ADDR)) {
+                next++;
+            }
+        }
+    }
+
+    for (i = 0; i < image->region_count; i++) {
+        Regionptr region = &image->regions[i];
+        region->hash = hash_words(image->words + region->start, region->end - region->start);
+    }
+}
+
+/**
+ * Collects the elements of a region: the offsets of its instructions, or of its data words.
+ *
+ * @param image     The image.
+ * @param region    The region.
+ * @param elements  Filled with the offsets of the elements.
+ *
+ * @return The number of elements.
+ */
+int collect_elements(Imageptr image, Regionptr region, int *elements) {
+    int count = 0;
+    int i;
+
+    for (i = region->start; i < region->end; i++) {
+        if (!region->is_code || image->lengths[i] > 0) {
+            elements[count++] = i;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Checks if an element of the old image equals an element of the new image.
+ *
+ * @param old_offset    The offset of the element in the old image.
+ * @param new_offset    The offset of the element in the new image.
+ *
+ * @return TRUE if the elements have the same normalized words, FALSE otherwise.
+ */
+boolean is_same_element(int old_offset, int new_offset) {
+    int length = old_offset < old_image.code_count ? old_image.lengths[old_offset] : 1;
+    int new_length = new_offset < new_image.code_count ? new_image.lengths[new_offset] : 1;
+
+    return length == new_length &&
+           memcmp(old_image.words + old_offset, new_image.words + new_offset, length * sizeof(unsigned int)) == 0;
+}
+
+/**
+ * Describes an element: its label and offset, and the name of an instruction or the value of a data word.
+ *
+ * @param image     The image.
+ * @param region    The region of the element.
+ * @param offset    The offset of the element in the image.
+ * @param buffer    The buffer the description is written into (MAX_LINE_LEN characters).
+ */
+void describe_element(Imageptr image, Regionptr region, int offset, char *buffer) {
+    unsigned int word = image->words[offset];
+    char *name;
+    int value;
+
+    if (region->is_code) {
+        name = image->lengths[offset] > 1 || get_instruction_length(word) == 1 ?
+               get_reserved_word_name(OPCODE_WORD, (int)extract_bits(word, ARE_BITS + ADDR_MODE_BITS, ARE_BITS + ADDR_MODE_BITS + OPCODE_BITS - 1)) : NULL;
+        sprintf(buffer, "%s+%d %s", region->name, offset - region->start, name != NULL ? name : "(invalid)");
+    } else {
+        /* Data words are 12-bit two's complement numbers */
+        value = (int)(word & ((1U << WORD_BITS) - 1));
+        if (value >= 1 << (WORD_BITS - 1)) {
+            value -= 1 << WORD_BITS;
+        }
+        sprintf(buffer, "%s+%d %d", region->name, offset - region->start, value);
+    }
+}
+
+/**
+ * Aligns the elements of a region of the old image with the elements of the region of the same name in the new
+ * image, and prints the changed, inserted and removed elements.
+ *
+ * @param old_region    The region of the old image.
+ * @param new_region    The region of the new image.
+ *
+ * @remarks Between two matching elements, the removed and inserted elements are paired as changed elements.
+ */
+void diff_region(Regionptr old_region, Regionptr new_region) {
+    int *old_elements;
+    int *new_elements;
+    int *lcs; /* The length of the longest common subsequence of each pair of suffixes */
+    int *run_removed;
+    int *run_inserted;
+    struct edit *edits;
+    int old_count;
+    int new_count;
+    int edit_count = 0;
+    int removed_count = 0;
+    int inserted_count = 0;
+    int counts[4] = {0, 0, 0, 0};
+    int columns;
+    int i;
+    int j;
+    int k;
+    char old_text[MAX_LINE_LEN + MAX_SYMBOL_LEN];
+    char new_text[MAX_LINE_LEN + MAX_SYMBOL_LEN];
+
+    old_elements = (int *)malloc((old_region->end - old_region->start + 1) * sizeof(int));
+    new_elements = (int *)malloc((new_region->end - new_region->start + 1) * sizeof(int));
+    if (old_elements == NULL || new_elements == NULL) {
+        print_error(MEM_ALLOC_FAILED);
+        exit(1);
+    }
+
+    old_count = collect_elements(&old_image, old_region, old_elements);
+    new_count = collect_elements(&new_image, new_region, new_elements);
+    columns = new_count + 1;
+
+    lcs = (int *)malloc((old_count + 1) * columns * sizeof(int));
+    run_removed = (int *)malloc((old_count + 1) * sizeof(int));
+    run_inserted = (int *)malloc((new_count + 1) * sizeof(int));
+    edits = (struct edit *)malloc((old_count + new_count + 1) * sizeof(struct edit));
+    if (lcs == NULL || run_removed == NULL || run_inserted == NULL || edits == NULL) {
+        print_error(MEM_ALLOC_FAILED);
+        exit(1);
+    }
+
+    for (i = old_count; i >= 0; i--) {
+        for (j = new_count; j >= 0; j--) {
+            if (i == old_count || j == new_count) {
+                lcs[i * columns + j] = 0;
+            } else if (is_same_element(old_elements[i], new_elements[j])) {
+                lcs[i * columns + j] = lcs[(i + 1) * columns + j + 1] + 1;
+            } else {
+                lcs[i * columns + j] = lcs[(i + 1) * columns + j] > lcs[i * columns + j + 1] ?
+                                       lcs[(i + 1) * columns + j] : lcs[i * columns + j + 1];
+            }
+        }
+    }
+
+    /* Follow the common subsequence, collecting the runs of removed and inserted elements between its elements */
+    i = 0;
+    j = 0;
+    while (i < old_count || j < new_count) {
+        boolean is_match = i < old_count && j < new_count && is_same_element(old_elements[i], new_elements[j]);
+
+        if (!is_match && j < new_count && (i == old_count || lcs[i * columns + j + 1] > lcs[(i + 1) * columns + j])) {
+            run_inserted[inserted_count++] = new_elements[j++];
+        } else if (!is_match) {
+            run_removed[removed_count++] = old_elements[i++];
+        }
+
+        /* A run ends at a match or at the end of both regions */
+        if (is_match || (i == old_count && j == new_count)) {
+            for (k = 0; k < removed_count || k < inserted_count; k++) {
+                edits[edit_count].kind = k < removed_count && k < inserted_count ? CHANGED_EDIT :
+                                         k < removed_count ? REMOVED_EDIT : INSERTED_EDIT;
+                edits[edit_count].old_offset = k < removed_count ? run_removed[k] : -1;
+                edits[edit_count].new_offset = k < inserted_count ? run_inserted[k] : -1;
+                counts[edits[edit_count++].kind]++;
+            }
+            removed_count = 0;
+            inserted_count = 0;
+        }
+
+        if (is_match) {
+            i++;
+            j++;
+        }
+    }
+
+    printf("  ~ %s: %d changed, %d inserted, %d removed\n", new_region->name, counts[CHANGED_EDIT], counts[INSERTED_EDIT],
+           counts[REMOVED_EDIT]);
+
+    for (k = 0; k < edit_count; k++) {
+        if (edits[k].old_offset != -1) {
+            describe_element(&old_image, old_region, edits[k].old_offset, old_text);
+        }
+        if (edits[k].new_offset != -1) {
+            describe_element(&new_image, new_region, edits[k].new_offset, new_text);
+        }
+
+        if (edits[k].kind == CHANGED_EDIT) {
+            printf("      ~ %s -> %s\n", old_text, new_text);
+        } else if (edits[k].kind == INSERTED_EDIT) {
+            printf("      + %s\n", new_text);
+        } else {
+            printf("      - %s\n", old_text);
+        }
+    }
+
+    free(old_elements);
+    free(new_elements);
+    free(lcs);
+    free(run_removed);
+    free(run_inserted);
+    free(edits);
+}
+
+/**
+ * Compares two images written by the assembler, region by region, and prints their differences.
+ *
+ * @param old_name  The name of the old image (without an extension).
+ * @param new_name  The name of the new image (without an extension).
+ */
+void diff_images(char *old_name, char *new_name) {
+    Regionptr old_region;
+    Regionptr new_region;
+    int unchanged_count = 0;
+    int i;
+
+    if (!load_image(old_name, &old_image) || !load_image(new_name, &new_image)) {
+        print_error(OBJ_DIFF_FAILED);
+        return;
+    }
+
+    printf("%s -> %s: Object diff (code %d -> %d words, data %d -> %d words)\n", old_name, new_name, old_image.code_count,
+           new_image.code_count, old_image.data_count, new_image.data_count);
+
+    for (i = 0; i < new_image.region_count; i++) {
+        new_region = &new_image.regions[i];
+        old_region = find_named_region(&old_image, new_region->name);
+
+        if (old_region == NULL) {
+            printf("  + %s: added (%d words)\n", new_region->name, new_region->end - new_region->start);
+        } else if (old_region->is_code != new_region->is_code) {
+            printf("  ~ %s: moved from the %s segment\n", new_region->name, old_region->is_code ? "code" : "data");
+        } else if (old_region->hash == new_region->hash && old_region->end - old_region->start == new_region->end - new_region->start &&
+                   memcmp(old_image.words + old_region->start, new_image.words + new_region->start,
+                          (new_region->end - new_region->start) * sizeof(unsigned int)) == 0) {
+            unchanged_count++;
+        } else {
+            diff_region(old_region, new_region);
+        }
+    }
+
+    for (i = 0; i < old_image.region_count; i++) {
+        old_region = &old_image.regions[i];
+        if (find_named_region(&new_image, old_region->name) == NULL) {
+            printf("  - %s: removed (%d words)\n", old_region->name, old_region->end - old_region->start);
+        }
+    }
+
+    printf("  %d labels unchanged\n", unchanged_count);
+}
@@ -0,0 +1,42 @@
+/**
+ * This header file declares the functions of the object diff. The diff aligns two images written by the assembler by
+ * their entry symbols, splitting each segment into the word runs of its labels, and compares the runs by hash before
+ * aligning the decoded instructions (or data words) of the runs that differ.
+ */
+
+#ifndef ASM_OBJECT_DIFF_H
+#define ASM_OBJECT_DIFF_H
+
+#include "utils.h"
+
+#define MAX_IMAGE_WORDS (2 * MEM_SIZE)
+#define WORD_BITS 12
+
+/* Forward declaration of the struct image */
+typedef struct image Image;
+
+/* Pointer to the struct image */
+typedef Image *Imageptr;
+
+/* Forward declaration of the struct image_region */
+typedef struct image_region Region;
+
+/* Pointer to the struct image_region */
+typedef Region *Regionptr;
+
+/* Enumeration for the kinds of edits between the elements of two regions */
+typedef enum edit_kind { SAME_EDIT, CHANGED_EDIT, INSERTED_EDIT, REMOVED_EDIT } edit_kind;
+
+boolean load_image(char *, Imageptr);
+boolean read_image_symbols(char *, Imageptr);
+int compare_regions(const void *, const void *);
+Regionptr find_region(Imageptr, int);
+Regionptr find_named_region(Imageptr, char *);
+void normalize_image(Imageptr);
+int collect_elements(Imageptr, Regionptr, int *);
+boolean is_same_element(int, int);
+void describe_element(Imageptr, Regionptr, int, char *);
+void diff_region(Regionptr, Regionptr);
+void diff_images(char *, char *);
+
+#endif
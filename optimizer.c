@@ -0,0 +1,722 @@
+/**
+ * This file contains the implementation of the optional optimization passes of the assembler.
+ * The passes run after the first pass on the statement list, mark the statements they eliminate as removed
+ * and then lay the segments out again, updating the first words in the code segment and the symbol addresses.
+ */
+
+#include <string.h>
+#include "optimizer.h"
+#include "utils.h"
+#include "globals.h"
+#include "expression.h"
+#include "symbol_structs.h"
+#include "statement_structs.h"
+
+/* Definition of a statement in the statement list (linked list) */
+struct stmt {
+    int line_num; /* The line number of the statement in the extended source file */
+    char *source; /* A copy of the source line of the statement (kept only for the listing file), or NULL */
+    char label[MAX_SYMBOL_LEN + 1]; /* The symbol defined by the statement, or an empty string */
+    statement_type type; /* The type of the statement (instruction, directive) */
+    opcode op; /* The opcode of an instruction statement */
+    directive dir; /* The directive of a directive statement */
+    char src[MAX_OPERAND_LEN + 1]; /* The source operand, or an empty string */
+    char dest[MAX_OPERAND_LEN + 1]; /* The destination operand (or the symbol of .entry/.extern), or an empty string */
+    addressing_mode src_mode; /* The addressing mode of the source operand */
+    addressing_mode dest_mode; /* The addressing mode of the destination operand */
+    int src_value; /* The number of an immediate or register source operand */
+    int dest_value; /* The number of an immediate or register destination operand */
+    unsigned int address; /* The offset of the statement in the code or data segment */
+    int word_count; /* The number of words the statement occupies in its segment */
+    int fixup_start; /* The index of the first expression fixup of the statement */
+    int fixup_count; /* The number of expression fixups of the statement */
+    boolean is_removed; /* Indicates if the statement was removed by an optimization pass */
+    boolean is_referenced; /* Indicates if the statement can be reached or referenced by the program */
+    Stmtptr alias; /* The data statement whose words a removed data statement shares, or NULL */
+    Stmtptr next; /* Pointer to the next statement in the statement list */
+};
+
+/**
+ * Performs the peephole optimization pass on the statement list.
+ * The pass removes instructions that have no effect: moving an operand onto itself, adding or subtracting 0,
+ * jumping (or branching) to the instruction that follows, and moving back the operands of the previous move.
+ *
+ * @return The number of words saved in the code segment.
+ *
+ * @remarks The function uses the global variables 'stmt_table' and 'ic', and must run after the first pass succeeded.
+ *          Only cmp updates the PSW, so removing the instructions above does not change the flow of the program.
+ *          The instructions the program patches (writes to their label) are kept, since their words may change.
+ *          An instruction whose place an expression depends on is kept, so the folded expressions keep their values.
+ */
+int optimize_peephole(void) {
+    int initial_ic = ic;
+    Stmtptr current_stmt;
+    Stmtptr previous_stmt;
+    boolean is_changed;
+
+    /* Removing an instruction may make another one redundant, so repeat until nothing changes */
+    do {
+        is_changed = FALSE;
+        previous_stmt = NULL;
+
+        for (current_stmt = find_next_instruction(stmt_table); current_stmt != NULL; current_stmt = find_next_instruction(current_stmt->next)) {
+            /* An instruction between the labels of an expression is kept, so the folded expression keeps its value */
+            if (is_redundant_instruction(previous_stmt, current_stmt) && !is_expr_layout_stmt(current_stmt)) {
+                current_stmt->is_removed = TRUE;
+                is_changed = TRUE;
+            } else {
+                previous_stmt = current_stmt;
+            }
+        }
+    } while (is_changed);
+
+    /* Assign the new addresses to the remaining statements and symbols */
+    relayout_segments();
+
+    return initial_ic - ic;
+}
+
+/**
+ * Checks if an instruction can be removed without changing the behavior of the program.
+ *
+ * @param previous  The instruction executed right before the checked one, or NULL if there is none.
+ * @param stmt      The instruction to check.
+ *
+ * @return TRUE if the instruction is redundant, FALSE otherwise.
+ */
+boolean is_redundant_instruction(Stmtptr previous, Stmtptr stmt) {
+    /* The program may write other words over an instruction it patches */
+    if (is_patched_instruction(stmt)) {
+        return FALSE;
+    }
+
+    switch (stmt->op) {
+        case MOV_OP:
+            /* Moving an operand onto itself */
+            if (strcmp(stmt->src, stmt->dest) == 0) {
+                return TRUE;
+            }
+            /* Moving back the operands of the previous move, unless the instruction can be reached by a jump */
+            return previous != NULL && is_reverse_move(previous, stmt) && !has_label_after(previous, stmt) &&
+                   !is_patched_instruction(previous);
+
+        case ADD_OP:
+        case SUB_OP:
+            /* Adding or subtracting 0 (the value of an expression that is folded later is not known yet) */
+            return stmt->fixup_count == 0 && is_zero_immediate(stmt->src_mode, stmt->src_value);
+
+        case JMP_OP:
+        case BNE_OP:
+            /* Jumping to the instruction that follows (a branch reaches it either way) */
+            return is_jump_to_next(stmt);
+
+        default:
+            break;
+    }
+
+    return FALSE;
+}
+
+/**
+ * Checks if a jump instruction targets the instruction that follows it.
+ *
+ * @param stmt The jump instruction to check.
+ *
+ * @return TRUE if the target of the jump is the next instruction, FALSE otherwise.
+ *
+ * @remarks The symbols of removed instructions refer to the instruction that follows them, so they are checked as well.
+ */
+boolean is_jump_to_next(Stmtptr stmt) {
+    Stmtptr current_stmt;
+
+    /* Only a symbol target is known before the program runs */
+    if (stmt->dest_mode != DIRECT_ADDR) {
+        return FALSE;
+    }
+
+    for (current_stmt = stmt->next; current_stmt != NULL; current_stmt = current_stmt->next) {
+        /* Data statements are not part of the code segment */
+        if (current_stmt->type != INSTRUCTION) {
+            continue;
+        }
+
+        if (strcmp(current_stmt->label, stmt->dest) == 0) {
+            return TRUE;
+        }
+
+        /* Stop at the first instruction that was not removed */
+        if (!current_stmt->is_removed) {
+            break;
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * Checks if a move instruction moves back the operands of the previous move instruction.
+ *
+ * @param previous  The previous instruction.
+ * @param stmt      The instruction to check.
+ *
+ * @return TRUE if both instructions are moves and the operands of the second are the swapped operands of the first.
+ */
+boolean is_reverse_move(Stmtptr previous, Stmtptr stmt) {
+    if (previous->op != MOV_OP || stmt->op != MOV_OP) {
+        return FALSE;
+    }
+
+    return strcmp(previous->src, stmt->dest) == 0 && strcmp(previous->dest, stmt->src) == 0;
+}
+
+/**
+ * Checks if any instruction after a given statement, up to and including the last statement, defines a symbol.
+ *
+ * @param from  The statement to start after.
+ * @param to    The last statement to check.
+ *
+ * @return TRUE if a symbol is defined by an instruction in the range, FALSE otherwise.
+ */
+boolean has_label_after(Stmtptr from, Stmtptr to) {
+    Stmtptr current_stmt = from;
+
+    do {
+        current_stmt = current_stmt->next;
+
+        if (current_stmt->type == INSTRUCTION && current_stmt->label[0] != '\0') {
+            return TRUE;
+        }
+    } while (current_stmt != to);
+
+    return FALSE;
+}
+
+/**
+ * Checks if an operand is the immediate number 0.
+ *
+ * @param addr_mode The addressing mode of the operand.
+ * @param value     The number of an immediate operand.
+ *
+ * @return TRUE if the operand is an immediate 0, FALSE otherwise.
+ */
+boolean is_zero_immediate(addressing_mode addr_mode, int value) {
+    return addr_mode == IMMEDIATE_ADDR && value == 0;
+}
+
+/**
+ * Finds the first instruction that was not removed, starting from the given statement.
+ *
+ * @param stmt The statement to start from (inclusive).
+ *
+ * @return A pointer to the instruction, or NULL if there is no such instruction.
+ */
+Stmtptr find_next_instruction(Stmtptr stmt) {
+    while (stmt != NULL && (stmt->type != INSTRUCTION || stmt->is_removed)) {
+        stmt = stmt->next;
+    }
+
+    return stmt;
+}
+
+/**
+ * Performs the unreachable code and unused data elimination pass on the statement list.
+ * The pass follows the program from its roots (the first instruction and the entry symbols) through the flow of the
+ * instructions and their symbol operands, and removes the instructions and data blocks that were not reached.
+ *
+ * @return The number of words removed from the code and data segments.
+ *
+ * @remarks The function uses the global variables 'stmt_table', 'ic' and 'dc', and must run after the first pass succeeded.
+ *          A jump through a register can reach any instruction, so if one exists no instruction is removed.
+ *          A statement whose place an expression depends on is kept, so the folded expressions keep their values.
+ */
+int eliminate_unreachable(void) {
+    int initial_size = ic + dc;
+    Stmtptr current_stmt;
+    boolean is_changed;
+    boolean is_flow_known = !has_register_jump();
+
+    /* The program starts at its first instruction */
+    mark_referenced(find_next_instruction(stmt_table));
+
+    for (current_stmt = stmt_table; current_stmt != NULL; current_stmt = current_stmt->next) {
+        /* Entry symbols can be referenced by other files */
+        if (current_stmt->type == DIRECTIVE && current_stmt->dir == ENTRY) {
+            mark_symbol_referenced(current_stmt->dest);
+        }
+
+        /* If the flow of the program is not known, every instruction can be reached */
+        if (current_stmt->type == INSTRUCTION && !is_flow_known) {
+            current_stmt->is_referenced = TRUE;
+        }
+    }
+
+    /* Marking a statement may reach statements that were already visited, so repeat until nothing changes */
+    do {
+        is_changed = FALSE;
+
+        for (current_stmt = find_next_instruction(stmt_table); current_stmt != NULL; current_stmt = find_next_instruction(current_stmt->next)) {
+            if (!current_stmt->is_referenced) {
+                continue;
+            }
+
+            /* The symbols used as operands are referenced (jump targets and data alike) */
+            if (current_stmt->src_mode == DIRECT_ADDR && mark_symbol_referenced(current_stmt->src)) {
+                is_changed = TRUE;
+            }
+
+            if (current_stmt->dest_mode == DIRECT_ADDR && mark_symbol_referenced(current_stmt->dest)) {
+                is_changed = TRUE;
+            }
+
+            /* So are the symbols used by the expressions of immediate operands */
+            if (mark_expr_referenced(current_stmt)) {
+                is_changed = TRUE;
+            }
+
+            /* The next instruction is reached unless the flow of the program leaves the current one unconditionally */
+            if (current_stmt->op != JMP_OP && current_stmt->op != RTS_OP && current_stmt->op != STOP_OP) {
+                if (mark_referenced(find_next_instruction(current_stmt->next))) {
+                    is_changed = TRUE;
+                }
+            }
+        }
+
+        /* The symbols used by the expressions of the referenced data statements are referenced as well */
+        for (current_stmt = find_next_data(stmt_table); current_stmt != NULL; current_stmt = find_next_data(current_stmt->next)) {
+            if (current_stmt->is_referenced && mark_expr_referenced(current_stmt)) {
+                is_changed = TRUE;
+            }
+        }
+    } while (is_changed);
+
+    /* Remove the instructions and data statements that were not reached, unless an expression depends on their place */
+    for (current_stmt = stmt_table; current_stmt != NULL; current_stmt = current_stmt->next) {
+        if ((current_stmt->type == INSTRUCTION || is_data_stmt(current_stmt)) && !current_stmt->is_referenced &&
+            !is_expr_layout_stmt(current_stmt)) {
+            current_stmt->is_removed = TRUE;
+        }
+    }
+
+    /* Assign the new addresses to the remaining statements and symbols */
+    relayout_segments();
+
+    return initial_size - (ic + dc);
+}
+
+/**
+ * Checks if the program contains a jump through a register, whose target is only known when the program runs.
+ *
+ * @return TRUE if a jmp, bne or jsr instruction uses a register operand, FALSE otherwise.
+ */
+boolean has_register_jump(void) {
+    Stmtptr current_stmt;
+
+    for (current_stmt = find_next_instruction(stmt_table); current_stmt != NULL; current_stmt = find_next_instruction(current_stmt->next)) {
+        if ((current_stmt->op == JMP_OP || current_stmt->op == BNE_OP || current_stmt->op == JSR_OP) && current_stmt->dest_mode == REG_DIRECT_ADDR) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * Marks the statement that defines a symbol as referenced.
+ *
+ * @param name The name of the symbol.
+ *
+ * @return TRUE if a statement was newly marked, FALSE otherwise (including external and unknown symbols).
+ */
+boolean mark_symbol_referenced(char *name) {
+    return mark_referenced(find_labeled_stmt(name));
+}
+
+/**
+ * Marks the statements that define the symbols used by the expressions of a statement as referenced.
+ *
+ * @param stmt The statement whose expressions are checked.
+ *
+ * @return TRUE if a statement was newly marked, FALSE otherwise.
+ */
+boolean mark_expr_referenced(Stmtptr stmt) {
+    char *names[MAX_EXPR_SYMBOLS];
+    boolean is_marked = FALSE;
+    int i, j, count;
+
+    for (i = stmt->fixup_start; i < stmt->fixup_start + stmt->fixup_count; i++) {
+        count = collect_expr_symbols(get_fixup_expr(i), names, 0, 0);
+        for (j = 0; j < count; j++) {
+            if (mark_symbol_referenced(names[j])) {
+                is_marked = TRUE;
+            }
+        }
+    }
+
+    return is_marked;
+}
+
+/**
+ * Marks a statement as referenced.
+ * A removed instruction stands for the instruction that follows it, and a data statement stands for its whole
+ * data block: the statement and the data statements without a symbol that follow it in the data segment.
+ *
+ * @param stmt The statement to mark, or NULL.
+ *
+ * @return TRUE if a statement was newly marked, FALSE otherwise.
+ */
+boolean mark_referenced(Stmtptr stmt) {
+    if (stmt != NULL && stmt->type == INSTRUCTION) {
+        stmt = find_next_instruction(stmt);
+    }
+
+    if (stmt == NULL || stmt->is_referenced) {
+        return FALSE;
+    }
+
+    if (is_data_stmt(stmt)) {
+        do {
+            stmt->is_referenced = TRUE;
+            stmt = find_next_data(stmt->next);
+        } while (stmt != NULL && stmt->label[0] == '\0');
+    } else {
+        stmt->is_referenced = TRUE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * Finds the statement that defines a symbol.
+ *
+ * @param name The name of the symbol.
+ *
+ * @return A pointer to the statement, or NULL if no statement defines the symbol.
+ */
+Stmtptr find_labeled_stmt(char *name) {
+    Stmtptr current_stmt;
+
+    for (current_stmt = stmt_table; current_stmt != NULL; current_stmt = current_stmt->next) {
+        if (strcmp(current_stmt->label, name) == 0) {
+            return current_stmt;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Checks if a statement places words in the data segment.
+ *
+ * @param stmt The statement to check.
+ *
+ * @return TRUE if the statement is a DATA or STRING directive, FALSE otherwise.
+ */
+boolean is_data_stmt(Stmtptr stmt) {
+    return stmt->type == DIRECTIVE && (stmt->dir == DATA || stmt->dir == STRING);
+}
+
+/**
+ * Finds the first data statement that was not removed, starting from the given statement.
+ *
+ * @param stmt The statement to start from (inclusive).
+ *
+ * @return A pointer to the data statement, or NULL if there is no such statement.
+ */
+Stmtptr find_next_data(Stmtptr stmt) {
+    while (stmt != NULL && (!is_data_stmt(stmt) || stmt->is_removed)) {
+        stmt = stmt->next;
+    }
+
+    return stmt;
+}
+
+/**
+ * Performs the data deduplication pass on the statement list.
+ * Each read-only data block (a labeled data statement and the unlabeled data statements that follow it) is hashed,
+ * and a block with the same words as an earlier block is removed, its symbol becoming an alias of the earlier block.
+ *
+ * @return The number of words saved in the data segment.
+ *
+ * @remarks The function uses the global variables 'stmt_table', 'data' and 'dc', and must run after the first pass succeeded.
+ *          A block is read-only if no instruction writes to its symbol and its symbol is not an entry symbol.
+ *          A block whose address an expression depends on is kept, so the folded expressions keep their values.
+ */
+int merge_identical_data(void) {
+    int initial_dc = dc;
+    Stmtptr blocks[MEM_SIZE]; /* The first statement of each kept block */
+    int block_lengths[MEM_SIZE]; /* The number of words of each kept block */
+    int block_chains[MEM_SIZE]; /* The index of the next kept block with the same hash bucket, or -1 */
+    int buckets[DEDUP_BUCKETS]; /* The index of the first kept block of each hash bucket, or -1 */
+    int block_count = 0;
+    int bucket, index, length;
+    Stmtptr current_stmt;
+    Stmtptr next_stmt;
+
+    for (bucket = 0; bucket < DEDUP_BUCKETS; bucket++) {
+        buckets[bucket] = -1;
+    }
+
+    for (current_stmt = find_next_data(stmt_table); current_stmt != NULL; current_stmt = find_next_data(current_stmt->next)) {
+        /* Only a labeled statement starts a block that can be aliased, and only once its words are known */
+        if (current_stmt->label[0] == '\0' || !is_read_only_symbol(current_stmt->label) || has_block_fixups(current_stmt)) {
+            continue;
+        }
+
+        length = get_block_length(current_stmt);
+        bucket = hash_words(data + current_stmt->address, length) % DEDUP_BUCKETS;
+
+        /* Look for an earlier block with the same words */
+        for (index = buckets[bucket]; index != -1; index = block_chains[index]) {
+            if (block_lengths[index] == length &&
+                memcmp(data + blocks[index]->address, data + current_stmt->address, length * sizeof(unsigned int)) == 0) {
+                break;
+            }
+        }
+
+        /* A block whose address an expression depends on is kept, and can still be the target of later blocks */
+        if (index == -1 || is_expr_layout_stmt(current_stmt)) {
+            /* Keep the block and add it to its hash bucket */
+            blocks[block_count] = current_stmt;
+            block_lengths[block_count] = length;
+            block_chains[block_count] = buckets[bucket];
+            buckets[bucket] = block_count;
+            block_count++;
+        } else {
+            /* Remove the block, its symbol refers to the words of the earlier block */
+            current_stmt->is_removed = TRUE;
+            current_stmt->alias = blocks[index];
+            for (next_stmt = find_next_data(current_stmt->next); next_stmt != NULL && next_stmt->label[0] == '\0'; next_stmt = find_next_data(next_stmt->next)) {
+                next_stmt->is_removed = TRUE;
+            }
+        }
+    }
+
+    /* Assign the new addresses to the remaining statements and symbols */
+    relayout_segments();
+
+    return initial_dc - dc;
+}
+
+/**
+ * Checks if the words of a symbol can only be read by the program.
+ *
+ * @param name The name of the symbol.
+ *
+ * @return TRUE if no instruction writes to the symbol and the symbol is not an entry symbol, FALSE otherwise.
+ */
+boolean is_read_only_symbol(char *name) {
+    Stmtptr current_stmt;
+
+    for (current_stmt = stmt_table; current_stmt != NULL; current_stmt = current_stmt->next) {
+        /* Other files can write to an entry symbol */
+        if (current_stmt->type == DIRECTIVE && current_stmt->dir == ENTRY && strcmp(current_stmt->dest, name) == 0) {
+            return FALSE;
+        }
+    }
+
+    return !is_written_symbol(name);
+}
+
+/**
+ * Checks if an instruction of the program writes to a symbol.
+ *
+ * @param name The name of the symbol.
+ *
+ * @return TRUE if an instruction that was not removed has the symbol as its written destination, FALSE otherwise.
+ */
+boolean is_written_symbol(char *name) {
+    Stmtptr current_stmt;
+
+    for (current_stmt = find_next_instruction(stmt_table); current_stmt != NULL; current_stmt = find_next_instruction(current_stmt->next)) {
+        /* Every instruction except cmp, prn and the jumps writes to its destination operand */
+        if (current_stmt->dest_mode == DIRECT_ADDR && current_stmt->op != CMP_OP && current_stmt->op != PRN_OP &&
+            current_stmt->op != JMP_OP && current_stmt->op != BNE_OP && current_stmt->op != JSR_OP &&
+            strcmp(current_stmt->dest, name) == 0) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * Checks if the program patches an instruction, by writing to the label of the instruction.
+ *
+ * @param stmt The instruction to check, or NULL.
+ *
+ * @return TRUE if the instruction is labeled and an instruction writes to its label, FALSE otherwise.
+ */
+boolean is_patched_instruction(Stmtptr stmt) {
+    return stmt != NULL && stmt->label[0] != '\0' && is_written_symbol(stmt->label);
+}
+
+/**
+ * Checks if a data block holds expressions that are folded after the optimization passes.
+ *
+ * @param stmt The labeled data statement that starts the block.
+ *
+ * @return TRUE if a statement of the block has an expression fixup, FALSE otherwise.
+ */
+boolean has_block_fixups(Stmtptr stmt) {
+    if (stmt->fixup_count > 0) {
+        return TRUE;
+    }
+
+    for (stmt = find_next_data(stmt->next); stmt != NULL && stmt->label[0] == '\0'; stmt = find_next_data(stmt->next)) {
+        if (stmt->fixup_count > 0) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * Checks if the value of an expression depends on the place of a statement, so removing the statement would change it.
+ * An expression depends on the statement if it uses the symbol of the statement, or if it takes the difference of two
+ * labels with the statement between them (the data segment follows the code segment).
+ *
+ * @param stmt The instruction, or the data statement, to check.
+ *
+ * @return TRUE if an expression fixup depends on the place of the statement, FALSE otherwise.
+ *
+ * @remarks The symbol addresses and the statement addresses must come from the same layout of the segments.
+ */
+boolean is_expr_layout_stmt(Stmtptr stmt) {
+    char *names[MAX_EXPR_SYMBOLS];
+    Stmtptr current_stmt;
+    int i, j, count;
+    unsigned int place, low, high, addr;
+    boolean is_range_known;
+
+    place = stmt->address + MEM_START + (stmt->type == INSTRUCTION ? 0 : ic);
+
+    for (current_stmt = stmt_table; current_stmt != NULL; current_stmt = current_stmt->next) {
+        for (i = current_stmt->fixup_start; i < current_stmt->fixup_start + current_stmt->fixup_count; i++) {
+            count = collect_expr_symbols(get_fixup_expr(i), names, 0, 0);
+            low = 0;
+            high = 0;
+            is_range_known = FALSE;
+
+            for (j = 0; j < count; j++) {
+                if (strcmp(names[j], stmt->label) == 0) {
+                    return TRUE;
+                }
+
+                /* External and unknown symbols are reported when the expression is folded */
+                if (!is_existing_symbol(symbol_table, names[j]) || is_extern_symbol(symbol_table, names[j])) {
+                    continue;
+                }
+
+                addr = get_symbol_addr(symbol_table, names[j]);
+                low = !is_range_known || addr < low ? addr : low;
+                high = !is_range_known || addr > high ? addr : high;
+                is_range_known = TRUE;
+            }
+
+            /* Removing a statement between two labels of the expression moves the later label */
+            if (count > 1 && is_range_known && place >= low && place < high) {
+                return TRUE;
+            }
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * Gets the number of words of the data block that starts with the given data statement.
+ *
+ * @param stmt The labeled data statement that starts the block.
+ *
+ * @return The number of words of the statement and of the unlabeled data statements that follow it.
+ */
+int get_block_length(Stmtptr stmt) {
+    int length = stmt->word_count;
+
+    for (stmt = find_next_data(stmt->next); stmt != NULL && stmt->label[0] == '\0'; stmt = find_next_data(stmt->next)) {
+        length += stmt->word_count;
+    }
+
+    return length;
+}
+
+/**
+ * Computes a hash of a sequence of words (FNV-1a).
+ *
+ * @param words The words to hash.
+ * @param count The number of words.
+ *
+ * @return The hash of the words.
+ */
+unsigned long hash_words(unsigned int *words, int count) {
+    unsigned long hash = FNV_OFFSET_BASIS;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        hash = (hash ^ words[i]) * FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/**
+ * Lays out the segments again after statements were removed.
+ * The first word of each remaining instruction is moved to its new address in the code segment, the words of each
+ * remaining data statement are moved to their new addresses in the data segment, and the symbols are given their
+ * new addresses. The symbol of a removed statement refers to the statement that follows it in its segment.
+ *
+ * @remarks The function uses and updates the global variables 'stmt_table', 'symbol_table', 'code', 'data', 'ic' and 'dc'.
+ *          The additional words are not encoded yet, so only the first word of each instruction is moved.
+ */
+void relayout_segments(void) {
+    Stmtptr current_stmt;
+    int new_ic = 0;
+    int new_dc = 0;
+    int i;
+
+    /* Move each remaining instruction down to its new address (addresses only decrease, so moving in order is safe) */
+    for (current_stmt = stmt_table; current_stmt != NULL; current_stmt = current_stmt->next) {
+        if (current_stmt->type != INSTRUCTION) {
+            continue;
+        }
+
+        if (current_stmt->label[0] != '\0') {
+            set_symbol_addr(symbol_table, current_stmt->label, new_ic + MEM_START);
+        }
+
+        if (!current_stmt->is_removed) {
+            code[new_ic] = code[current_stmt->address];
+            current_stmt->address = new_ic;
+            new_ic += current_stmt->word_count;
+        }
+    }
+
+    ic = new_ic;
+
+    /* Move each remaining data statement down to its new address, the data segment follows the code segment */
+    for (current_stmt = stmt_table; current_stmt != NULL; current_stmt = current_stmt->next) {
+        if (!is_data_stmt(current_stmt)) {
+            continue;
+        }
+
+        if (current_stmt->label[0] != '\0') {
+            if (current_stmt->alias != NULL) {
+                /* The symbol of a merged block refers to the block it is an alias of, which was already moved */
+                set_symbol_addr(symbol_table, current_stmt->label, ic + MEM_START + current_stmt->alias->address);
+            } else {
+                set_symbol_addr(symbol_table, current_stmt->label, ic + MEM_START + new_dc);
+            }
+        }
+
+        if (!current_stmt->is_removed) {
+            for (i = 0; i < current_stmt->word_count; i++) {
+                data[new_dc + i] = data[current_stmt->address + i];
+            }
+            current_stmt->address = new_dc;
+            new_dc += current_stmt->word_count;
+        }
+    }
+
+    dc = new_dc;
+}
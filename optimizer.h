@@ -0,0 +1,42 @@
+/**
+ * This header file declares the functions of the optional optimization passes. The optimization passes run between
+ * the first and second passes, rewrite the statement list built by the first pass and lay the segments out again,
+ * so the output is semantically equivalent to the unoptimized program while taking fewer words.
+ */
+
+#ifndef ASM_OPTIMIZER_H
+#define ASM_OPTIMIZER_H
+
+#include "utils.h"
+#include "statement_structs.h"
+
+#define DEDUP_BUCKETS 256
+#define FNV_OFFSET_BASIS 2166136261UL
+#define FNV_PRIME 16777619UL
+
+int optimize_peephole(void);
+boolean is_redundant_instruction(Stmtptr, Stmtptr);
+boolean is_jump_to_next(Stmtptr);
+boolean is_reverse_move(Stmtptr, Stmtptr);
+boolean has_label_after(Stmtptr, Stmtptr);
+boolean is_zero_immediate(addressing_mode, int);
+Stmtptr find_next_instruction(Stmtptr);
+int eliminate_unreachable(void);
+boolean has_register_jump(void);
+boolean mark_symbol_referenced(char *);
+boolean mark_expr_referenced(Stmtptr);
+boolean mark_referenced(Stmtptr);
+Stmtptr find_labeled_stmt(char *);
+boolean is_data_stmt(Stmtptr);
+Stmtptr find_next_data(Stmtptr);
+int merge_identical_data(void);
+boolean is_read_only_symbol(char *);
+boolean is_written_symbol(char *);
+boolean is_patched_instruction(Stmtptr);
+boolean has_block_fixups(Stmtptr);
+boolean is_expr_layout_stmt(Stmtptr);
+int get_block_length(Stmtptr);
+unsigned long hash_words(unsigned int *, int);
+void relayout_segments(void);
+
+#endif
\ No newline at end of file
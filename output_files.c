@@ -195,4 +195,86 @@ char *convert_to_base64(unsigned int word) {
     encoded_string[2] = '\0';
 
     return encoded_string;
-}
\ No newline at end of file
+}
+
+/**
+ * Opens the listing file, which the second pass writes while it encodes the statements.
+ *
+ * @param source_filename The name of the source file.
+ *
+ * @return The file descriptor of the listing file, or NULL if it cannot be created.
+ */
+FILE *open_listing_file(char *source_filename) {
+    char *modified_filename_listing = generate_new_filename(source_filename, FILE_LISTING);
+    FILE *listing_fd = fopen(modified_filename_listing, "w");
+
+    free(modified_filename_listing);
+
+    if (listing_fd == NULL) {
+        print_error(CANNOT_CREATE_FILE);
+        return NULL;
+    }
+
+    /* The rows are small, so a large buffer lets the whole listing be written in a few writes */
+    setvbuf(listing_fd, NULL, _IOFBF, LISTING_BUFFER_SIZE);
+
+    fprintf(listing_fd, "Addr  Binary        B64  Source\n");
+
+    return listing_fd;
+}
+
+/**
+ * Writes a row of the listing file: the address and the encoded word (in binary and in Base64) followed by the
+ * source line, or only the source line of a statement without words.
+ *
+ * @param fd        The file descriptor of the listing file.
+ * @param address   The address of the word, or -1 for a statement without words.
+ * @param word      The encoded word.
+ * @param source    The source line (for the first word of a statement), or NULL.
+ */
+void write_listing_line(FILE *fd, int address, unsigned int word, char *source) {
+    char binary[SECOND_HALF_END + 2];
+    char *encoded_string;
+    int i;
+
+    if (address < 0) {
+        fprintf(fd, "%-20s%s\n", "", source != NULL ? source : "");
+        return;
+    }
+
+    /* Write the bits of the word from the most significant one */
+    for (i = 0; i <= SECOND_HALF_END; i++) {
+        binary[i] = (word >> (SECOND_HALF_END - i)) & 1 ? '1' : '0';
+    }
+    binary[SECOND_HALF_END + 1] = '\0';
+
+    encoded_string = convert_to_base64(word);
+    fprintf(fd, "%04d  %s  %s", address, binary, encoded_string);
+    free(encoded_string);
+
+    if (source != NULL) {
+        fprintf(fd, "   %s", source);
+    }
+    fputc('\n', fd);
+}
+
+/**
+ * Closes the listing file, and deletes it if the program has errors.
+ *
+ * @param fd                The file descriptor of the listing file.
+ * @param source_filename   The name of the source file.
+ * @param is_valid          Indicates if the program was assembled without errors.
+ */
+void close_listing_file(FILE *fd, char *source_filename, boolean is_valid) {
+    char *modified_filename_listing;
+
+    fclose(fd);
+
+    if (!is_valid) {
+        modified_filename_listing = generate_new_filename(source_filename, FILE_LISTING);
+        if (remove(modified_filename_listing) != 0) {
+            print_error(CANNOT_DELETE_FILE);
+        }
+        free(modified_filename_listing);
+    }
+}
@@ -14,11 +14,15 @@
 #define FIRST_HALF_END 5
 #define SECOND_HALF_START 6
 #define SECOND_HALF_END 11
+#define LISTING_BUFFER_SIZE 65536
 
 void create_output_files(char *);
 void create_ent_file(FILE *);
 void create_ext_file(FILE *);
 void create_ob_file(FILE *);
 char *convert_to_base64(unsigned int);
+FILE *open_listing_file(char *);
+void write_listing_line(FILE *, int, unsigned int, char *);
+void close_listing_file(FILE *, char *, boolean);
 
 #endif
\ No newline at end of file
@@ -9,15 +9,30 @@
 #include "pre_asm.h"
 #include "utils.h"
 #include "globals.h"
+#include "report.h"
 
 /* Definition of the struct mcr */
 struct mcr {
     char name[MAX_MCR_LEN]; /* Name of the macro */
     char **lines; /* Array of lines in the macro definition */
     int line_count; /* Number of lines in the macro */
+    char **flat_lines; /* Lines of the macro with the nested macro invocations expanded (shared with the macro table) */
+    int flat_line_count; /* Number of lines in the flattened macro */
+    int flat_line_capacity; /* Number of lines the flattened line array can hold */
+    flatten_state state; /* The state of the flattening of the macro body */
     Mcrptr next; /* Pointer to the next macro in the linked list */
 };
 
+static char *extended_text; /* The extended source written in memory, when the program is assembled in memory */
+static int extended_len; /* The number of used characters of the extended source */
+static int extended_capacity; /* The number of characters the extended source can hold */
+
+/* Definition of the struct def */
+struct def {
+    char name[MAX_MCR_LEN + 1]; /* Name of the defined symbol */
+    Defptr next; /* Pointer to the next defined symbol in the linked list */
+};
+
 /**
  * Creates a new macro with the given name.
  *
@@ -35,6 +50,10 @@ Mcrptr create_macro(char *name) {
     strcpy(macro->name, name);
     macro->lines = NULL;
     macro->line_count = 0;
+    macro->flat_lines = NULL;
+    macro->flat_line_count = 0;
+    macro->flat_line_capacity = 0;
+    macro->state = NOT_FLATTENED;
     macro->next = NULL;
 
     return macro;
@@ -120,6 +139,9 @@ void free_macro(Mcrptr *macro) {
     /* Free the memory allocated for the line array */
     free((*macro)->lines);
 
+    /* Free the flattened line array, its lines belong to the line arrays of the macros */
+    free((*macro)->flat_lines);
+
     /* Free the memory allocated for the macro itself */
     free(*macro);
 
@@ -185,61 +207,422 @@ Mcrptr find_macro(Mcrptr macro_table, char *name) {
 }
 
 /**
- * Expands a macro by writing its lines to the output file.
+ * Appends a line to the flattened body of a macro.
+ *
+ * @param macro The macro whose flattened body is extended.
+ * @param line  The line to be appended (not copied).
+ */
+void append_flat_line(Mcrptr macro, char *line) {
+    char **new_lines;
+
+    /* Double the capacity of the flattened line array when it is full */
+    if (macro->flat_line_count == macro->flat_line_capacity) {
+        macro->flat_line_capacity = macro->flat_line_capacity ? macro->flat_line_capacity * 2 : FLAT_LINES_INITIAL_CAPACITY;
+        new_lines = (char **)realloc(macro->flat_lines, macro->flat_line_capacity * sizeof(char *));
+        if (new_lines == NULL) {
+            print_error(MEM_REALLOC_FAILED);
+            exit(1);
+        }
+        macro->flat_lines = new_lines;
+    }
+
+    macro->flat_lines[macro->flat_line_count++] = line;
+}
+
+/**
+ * Computes the flattened body of a macro, in which every invocation of another macro is replaced by the flattened
+ * body of that macro. The flattened body is computed once, on the first expansion of the macro, and then reused.
  *
- * @param output_file   The pointer to the output file where the expanded macro lines will be written.
  * @param macro_table   The pointer to the macro table (linked list) containing all the defined macros.
- * @param macro_name    The name of the macro to be expanded.
+ * @param macro         The macro to be flattened.
+ *
+ * @return TRUE if the macro was flattened, FALSE if it invokes itself directly or through other macros.
  */
-void expand_macro(FILE *output_file, Mcrptr macro_table, char *macro_name) {
-    /* Find the macro with the given name in the macro table */
-    Mcrptr macro = find_macro(macro_table, macro_name);
-    int i;
+boolean flatten_macro(Mcrptr macro_table, Mcrptr macro) {
+    char trimmed_line[MAX_LINE_LEN];
+    Mcrptr nested_macro;
+    int i, j;
+
+    if (macro->state == FLATTENED) {
+        return TRUE;
+    }
+
+    /* Reaching a macro whose flattening is in progress means the invocations form a cycle */
+    if (macro->state == FLATTENING) {
+        print_error(MCR_RECURSIVE);
+        return FALSE;
+    }
+
+    macro->state = FLATTENING;
 
-    /* Write each line of the macro to the output file */
     for (i = 0; i < macro->line_count; i++) {
-        fprintf(output_file, "%s", macro->lines[i]);
+        strcpy(trimmed_line, macro->lines[i]);
+        trim_whitespaces(trimmed_line);
+
+        nested_macro = find_macro(macro_table, trimmed_line);
+        if (nested_macro == NULL) {
+            append_flat_line(macro, macro->lines[i]);
+            continue;
+        }
+
+        if (!flatten_macro(macro_table, nested_macro)) {
+            return FALSE;
+        }
+
+        for (j = 0; j < nested_macro->flat_line_count; j++) {
+            append_flat_line(macro, nested_macro->flat_lines[j]);
+        }
     }
+
+    macro->state = FLATTENED;
+
+    return TRUE;
 }
 
 /**
- * Checks if a given token is a valid macro name.
+ * Expands a macro by writing its flattened lines to the output file.
  *
- * @param token The token to be checked as a macro name.
+ * @param output_file   The pointer to the output file where the expanded macro lines will be written, or NULL.
+ * @param macro_table   The pointer to the macro table (linked list) containing all the defined macros.
+ * @param macro         The macro to be expanded.
  *
- * @return TRUE if the token is a valid macro name, otherwise returns FALSE.
+ * @return TRUE if the macro was expanded, FALSE if it invokes itself directly or through other macros.
  */
-boolean is_macro(char *token) {
-    int token_len = strlen(token);
+boolean expand_macro(FILE *output_file, Mcrptr macro_table, Mcrptr macro) {
+    int i;
+
+    /* Flatten the macro on its first expansion */
+    if (!flatten_macro(macro_table, macro)) {
+        return FALSE;
+    }
+
+    /* Write each line of the flattened macro to the output file */
+    for (i = 0; i < macro->flat_line_count; i++) {
+        write_extended_line(output_file, macro->flat_lines[i]);
+    }
+
+    return TRUE;
+}
+
+/**
+ * Writes a line of the extended source, to the .am file or to the extended source in memory.
+ *
+ * @param output_file   The pointer to the .am file, or NULL if the program is assembled in memory.
+ * @param line          The line to write.
+ */
+void write_extended_line(FILE *output_file, char *line) {
+    char *new_text;
+    int line_len;
+
+    if (output_file != NULL) {
+        fputs(line, output_file);
+        return;
+    }
+
+    /* Double the capacity of the extended source until the line and its null character fit */
+    line_len = strlen(line);
+    if (extended_len + line_len + 1 > extended_capacity) {
+        while (extended_len + line_len + 1 > extended_capacity) {
+            extended_capacity = extended_capacity ? extended_capacity * 2 : EXTENDED_TEXT_INITIAL_CAPACITY;
+        }
+        new_text = (char *)realloc(extended_text, extended_capacity * sizeof(char));
+        if (new_text == NULL) {
+            print_error(MEM_REALLOC_FAILED);
+            exit(1);
+        }
+        extended_text = new_text;
+    }
+
+    strcpy(extended_text + extended_len, line);
+    extended_len += line_len;
+}
+
+/**
+ * Reads the next line of the extended source, from the .am file or from the extended source in memory.
+ * Like fgets, a line longer than the buffer is read in parts.
+ *
+ * @param line          The buffer the line is read into.
+ * @param size          The size of the buffer.
+ * @param input_file    The pointer to the .am file, or NULL if the program is assembled in memory.
+ * @param offset        The offset of the next line in the extended source in memory, updated by the function.
+ *
+ * @return The buffer, or NULL at the end of the extended source.
+ */
+char *read_extended_line(char *line, int size, FILE *input_file, int *offset) {
+    int line_len = 0;
+
+    if (input_file != NULL) {
+        return fgets(line, size, input_file);
+    }
+
+    if (*offset >= extended_len) {
+        return NULL;
+    }
+
+    /* Copy up to and including the next newline, leaving room for the null character */
+    while (line_len < size - 1 && *offset < extended_len) {
+        line[line_len++] = extended_text[(*offset)++];
+        if (line[line_len - 1] == '\n') {
+            break;
+        }
+    }
+    line[line_len] = '\0';
+
+    return line;
+}
+
+/**
+ * Frees the extended source kept in memory.
+ */
+void free_extended_text(void) {
+    free(extended_text);
+    extended_text = NULL;
+    extended_len = 0;
+    extended_capacity = 0;
+}
+
+/**
+ * Adds a symbol to the head of a linked list of defined symbols.
+ *
+ * @param head The address of the pointer to the head of the linked list.
+ * @param name The name of the symbol to be defined.
+ */
+void add_define(Defptr *head, char *name) {
+    Defptr new_def = (Defptr)malloc(sizeof(Def));
+    if (new_def == NULL) {
+        print_error(MEM_ALLOC_FAILED);
+        exit(1);
+    }
+
+    strcpy(new_def->name, name);
+    new_def->next = *head;
+    *head = new_def;
+}
+
+/**
+ * Checks if a symbol is defined in a linked list of defined symbols.
+ *
+ * @param head The head of the linked list.
+ * @param name The name of the symbol.
+ *
+ * @return TRUE if the symbol is defined, FALSE otherwise.
+ */
+boolean is_defined(Defptr head, char *name) {
+    while (head != NULL) {
+        if (strcmp(head->name, name) == 0) {
+            return TRUE;
+        }
+        head = head->next;
+    }
+
+    return FALSE;
+}
+
+/**
+ * Frees the memory allocated for a linked list of defined symbols.
+ *
+ * @param head A pointer to the head pointer of the linked list.
+ */
+void free_defines(Defptr *head) {
+    Defptr next;
+
+    while (*head != NULL) {
+        next = (*head)->next;
+        free(*head);
+        *head = next;
+    }
+}
+
+/**
+ * Finds the conditional assembly directive a line starts with.
+ *
+ * @param line The line, starting at its first non-whitespace character.
+ *
+ * @return The conditional directive, or NONE_COND if the line does not start with one.
+ *
+ * @remarks Only the first characters of the line are compared, so the lines of a disabled region are skipped without
+ *          being copied or tokenized.
+ */
+cond_directive find_conditional(char *line) {
+    cond_directive cond;
+    char *keyword;
+    int len;
+
+    /* Dispatch on the first character, so most lines are rejected after a single comparison */
+    switch (line[0]) {
+        case 'd':
+            cond = DEFINE_COND;
+            keyword = "define";
+            break;
+        case 'i':
+            cond = IFDEF_COND;
+            keyword = "ifdef";
+            break;
+        case 'e':
+            cond = line[1] == 'l' ? ELSE_COND : ENDIF_COND;
+            keyword = cond == ELSE_COND ? "else" : "endif";
+            break;
+        default:
+            return NONE_COND;
+    }
+
+    len = strlen(keyword);
+    if (strncmp(line, keyword, len) != 0) {
+        return NONE_COND;
+    }
+
+    /* The keyword must be a whole word */
+    if (line[len] != '\0' && line[len] != ' ' && line[len] != '\t' && line[len] != '\n') {
+        return NONE_COND;
+    }
+
+    return cond;
+}
+
+/**
+ * Reads the symbol name of a define or ifdef directive.
+ *
+ * @param params    The trimmed text after the directive keyword.
+ * @param name      A buffer of at least MAX_MCR_LEN + 1 characters that receives the name.
+ *
+ * @return TRUE if the name is valid, FALSE otherwise.
+ */
+boolean read_conditional_name(char *params, char *name) {
+    char *token = strtok(params, " \t");
 
     if (token == NULL) {
+        print_error(COND_MISSING_NAME);
         return FALSE;
     }
 
-    /* Check if the token length exceeds the maximum allowed macro length */
-    if (token_len > MAX_MCR_LEN) {
+    if (strlen(token) > MAX_MCR_LEN) {
         print_error(MCR_TOO_LONG);
         return FALSE;
     }
 
-    /* Check if the token is a register name */
-    if (is_register(token)) {
-        print_error(MCR_CANNOT_BE_REG);
+    strcpy(name, token);
+
+    if (strtok(NULL, " \t") != NULL) {
+        print_error(COND_EXTRANEOUS_TEXT);
         return FALSE;
     }
 
-    /* Check if the token matches any operation name */
-    if (find_operation(token) != NONE_OP) {
-        print_error(MCR_CANNOT_BE_OP);
+    return TRUE;
+}
+
+/**
+ * Processes a conditional assembly directive.
+ *
+ * @param cond              The conditional directive.
+ * @param params            The trimmed text after the directive keyword (NULL inside a disabled region).
+ * @param define_table      The address of the pointer to the symbols defined by the define directives of the file.
+ * @param is_else_seen      For each open ifdef directive, indicates if its else directive was seen.
+ * @param cond_depth        The address of the number of open ifdef directives.
+ * @param disabled_depth    The address of the depth of the ifdef directive whose disabled branch is being skipped,
+ *                          or 0 if the lines are enabled.
+ *
+ * @return TRUE if the directive was processed successfully, FALSE otherwise.
+ *
+ * @remarks The function uses the global variable 'cmd_define_table' holding the symbols defined on the command line.
+ */
+boolean process_conditional(cond_directive cond, char *params, Defptr *define_table, boolean *is_else_seen, int *cond_depth, int *disabled_depth) {
+    char name[MAX_MCR_LEN + 1];
+
+    /* Inside a disabled region only the nesting is tracked */
+    if (!*disabled_depth) {
+        if (cond == DEFINE_COND || cond == IFDEF_COND) {
+            if (!read_conditional_name(params, name)) {
+                return FALSE;
+            }
+        } else if (!is_empty(params)) {
+            print_error(COND_EXTRANEOUS_TEXT);
+            return FALSE;
+        }
+    }
+
+    switch (cond) {
+        case DEFINE_COND:
+            if (!*disabled_depth) {
+                add_define(define_table, name);
+            }
+            break;
+        case IFDEF_COND:
+            if (*cond_depth == MAX_COND_DEPTH) {
+                print_error(COND_TOO_DEEP);
+                return FALSE;
+            }
+            is_else_seen[(*cond_depth)++] = FALSE;
+            if (!*disabled_depth && !is_defined(*define_table, name) && !is_defined(cmd_define_table, name)) {
+                *disabled_depth = *cond_depth;
+            }
+            break;
+        case ELSE_COND:
+            if (*cond_depth == 0 || is_else_seen[*cond_depth - 1]) {
+                print_error(COND_UNMATCHED);
+                return FALSE;
+            }
+            is_else_seen[*cond_depth - 1] = TRUE;
+            if (*disabled_depth == *cond_depth) {
+                *disabled_depth = 0;
+            } else if (!*disabled_depth) {
+                *disabled_depth = *cond_depth;
+            }
+            break;
+        case ENDIF_COND:
+            if (*cond_depth == 0) {
+                print_error(COND_UNMATCHED);
+                return FALSE;
+            }
+            if (*disabled_depth == *cond_depth) {
+                *disabled_depth = 0;
+            }
+            (*cond_depth)--;
+            break;
+        default:
+            break;
+    }
+
+    return TRUE;
+}
+
+/**
+ * Checks if a given token is a valid macro name.
+ *
+ * @param token The token to be checked as a macro name.
+ *
+ * @return TRUE if the token is a valid macro name, otherwise returns FALSE.
+ */
+boolean is_macro(char *token) {
+    int token_len = strlen(token);
+
+    if (token == NULL) {
         return FALSE;
     }
 
-    /* Check if the token matches any directive name */
-    if (find_directive(token) != NONE_DIR) {
-        print_error(MCR_CANNOT_BE_DIR);
+    /* Check if the token length exceeds the maximum allowed macro length */
+    if (token_len > MAX_MCR_LEN) {
+        print_error(MCR_TOO_LONG);
         return FALSE;
     }
 
+    /* Check if the token is a register, an operation, a directive or a macro keyword */
+    switch (classify_word(token, NULL)) {
+        case REGISTER_WORD:
+            print_error(MCR_CANNOT_BE_REG);
+            return FALSE;
+        case OPCODE_WORD:
+            print_error(MCR_CANNOT_BE_OP);
+            return FALSE;
+        case DIRECTIVE_WORD:
+            print_error(MCR_CANNOT_BE_DIR);
+            return FALSE;
+        case MACRO_KEYWORD_WORD:
+            print_error(MCR_CANNOT_BE_KEYWORD);
+            return FALSE;
+        default:
+            break;
+    }
+
     return TRUE;
 }
 
@@ -260,13 +643,28 @@ boolean pre_process(char *source_filename) {
     FILE *extended_src_fd;
     Mcrptr macro_table;
     Mcrptr current_macro;
+    Mcrptr invoked_macro;
+    Defptr define_table; /* The symbols defined by the define directives of the file */
+    boolean is_else_seen[MAX_COND_DEPTH]; /* For each open ifdef directive, indicates if its else directive was seen */
+    int cond_depth; /* The number of open ifdef directives */
+    int disabled_depth; /* The depth of the ifdef directive whose disabled branch is being skipped, or 0 */
+    cond_directive cond;
     boolean is_inside_macro;
     boolean success;
+    int output_line; /* The line number of the next line written to the output file */
 
     line_num = 1;
+    output_line = 1;
+
+    /* Forget the expansion sites and the extended source of the previous file */
+    free_expansion_sites();
+    free_extended_text();
 
     macro_table = NULL;
     current_macro = NULL; /* Pointer to the currently processed macro */
+    define_table = NULL;
+    cond_depth = 0;
+    disabled_depth = 0;
     is_inside_macro = FALSE; /* Flag indicating if we're inside a macro definition */
     success = TRUE; /* Flag to track the success of the process */
 
@@ -311,8 +709,9 @@ boolean pre_process(char *source_filename) {
         return FALSE;
     }
 
-    extended_src_fd = fopen(modified_filename_macro, "w");
-    if (extended_src_fd == NULL) {
+    /* When the program is assembled in memory, the extended source is kept in memory instead of the .am file */
+    extended_src_fd = is_memory_mode ? NULL : fopen(modified_filename_macro, "w");
+    if (extended_src_fd == NULL && !is_memory_mode) {
         print_error(CANNOT_CREATE_FILE);
         free(modified_filename_source);
         free(modified_filename_macro);
@@ -325,12 +724,33 @@ boolean pre_process(char *source_filename) {
 
     /* Process each line of the source file */
     while (fgets(line, MAX_LINE_LEN, initial_src_fd)) {
+        /* Inside a disabled region only the conditional directives matter, so look for them without copying the line */
+        if (disabled_depth) {
+            cond = find_conditional(line + strspn(line, " \t"));
+            if (cond != NONE_COND && !process_conditional(cond, NULL, &define_table, is_else_seen, &cond_depth, &disabled_depth)) {
+                success = FALSE;
+                break;
+            }
+
+            line_num++;
+            continue;
+        }
+
         /* Create a trimmed copy of the line */
         strcpy(trimmed_line, line);
         trim_whitespaces(trimmed_line);
 
+        /* Check if the line is a conditional assembly directive */
+        if ((cond = find_conditional(trimmed_line)) != NONE_COND) {
+            /* Skip the keyword, the directive parameters follow it */
+            char *params = trimmed_line + strcspn(trimmed_line, " \t");
+
+            if (!process_conditional(cond, params, &define_table, is_else_seen, &cond_depth, &disabled_depth)) {
+                success = FALSE;
+                break;
+            }
         /* Check if the line is a macro definition */
-        if (strncmp(trimmed_line, "mcro", 4) == 0) {
+        } else if (strncmp(trimmed_line, "mcro", 4) == 0) {
             /* Extract the macro name */
             char *token = strtok(trimmed_line + 4, " ");
 
@@ -373,32 +793,55 @@ boolean pre_process(char *source_filename) {
         } else if (is_inside_macro) {
             add_line_to_macro(current_macro, line);
         /* Check if the line matches any defined macro */
-        } else if (find_macro(macro_table, trimmed_line) != NULL) {
+        } else if ((invoked_macro = find_macro(macro_table, trimmed_line)) != NULL) {
             /* Expand the macro and write it to the output file */
-            expand_macro(extended_src_fd, macro_table, trimmed_line);
+            if (!expand_macro(extended_src_fd, macro_table, invoked_macro)) {
+                success = FALSE;
+                break;
+            }
+
+            /* Record where the invocation was expanded, for the size report */
+            if (is_size_report_enabled) {
+                add_expansion_site(invoked_macro->name, line_num, output_line, invoked_macro->flat_line_count);
+            }
+            output_line += invoked_macro->flat_line_count;
         /* The line is not a macro, write it to the output file as is */
         } else {
-            fprintf(extended_src_fd, "%s", line);
+            write_extended_line(extended_src_fd, line);
+            output_line++;
         }
 
         line_num++;
     }
 
+    /* Every ifdef directive must be closed by an endif directive */
+    if (success && cond_depth > 0) {
+        print_error(COND_MISSING_ENDIF);
+        success = FALSE;
+    }
+
     free_linked_list(&macro_table);
+    free_defines(&define_table);
 
     free(line);
     free(trimmed_line);
     free(macro_name);
 
     fclose(initial_src_fd);
-    fclose(extended_src_fd);
+    if (extended_src_fd != NULL) {
+        fclose(extended_src_fd);
+    }
 
     /* Clean up in case of failure */
     if (!success) {
-        boolean remove_result = remove(modified_filename_macro);
-        if (remove_result != FALSE) {
-            print_error(CANNOT_DELETE_FILE);
+        if (extended_src_fd != NULL) {
+            boolean remove_result = remove(modified_filename_macro);
+            if (remove_result != FALSE) {
+                print_error(CANNOT_DELETE_FILE);
+            }
         }
+        free_expansion_sites();
+        free_extended_text();
     }
 
     free(modified_filename_source);
@@ -10,6 +10,12 @@
 #include "utils.h"
 
 #define MAX_MCR_LEN 31
+#define FLAT_LINES_INITIAL_CAPACITY 16
+#define MAX_COND_DEPTH 32
+#define EXTENDED_TEXT_INITIAL_CAPACITY 4096
+
+/* Enumeration for the states of the flattening of a macro body */
+typedef enum flatten_state { NOT_FLATTENED, FLATTENING, FLATTENED } flatten_state;
 
 /* Forward declaration of the struct mcr */
 typedef struct mcr Mcr;
@@ -17,13 +23,33 @@ typedef struct mcr Mcr;
 /* Pointer to the struct mcr */
 typedef Mcr *Mcrptr;
 
+/* Forward declaration of the struct def */
+typedef struct def Def;
+
+/* Pointer to the struct def */
+typedef Def *Defptr;
+
+/* Enumeration for the conditional assembly directives */
+typedef enum cond_directive { NONE_COND, DEFINE_COND, IFDEF_COND, ELSE_COND, ENDIF_COND } cond_directive;
+
 Mcrptr create_macro(char *);
 Mcrptr add_macro_to_list(Mcrptr *, char *);
 void add_line_to_macro(Mcrptr, char *);
 void free_macro(Mcrptr *);
 void free_linked_list(Mcrptr *);
 Mcrptr find_macro(Mcrptr, char *);
-void expand_macro(FILE *, Mcrptr, char *);
+boolean flatten_macro(Mcrptr, Mcrptr);
+void append_flat_line(Mcrptr, char *);
+boolean expand_macro(FILE *, Mcrptr, Mcrptr);
+void write_extended_line(FILE *, char *);
+char *read_extended_line(char *, int, FILE *, int *);
+void free_extended_text(void);
+void add_define(Defptr *, char *);
+boolean is_defined(Defptr, char *);
+void free_defines(Defptr *);
+cond_directive find_conditional(char *);
+boolean read_conditional_name(char *, char *);
+boolean process_conditional(cond_directive, char *, Defptr *, boolean *, int *, int *);
 boolean pre_process(char *);
 
 #endif
\ No newline at end of file
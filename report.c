@@ -0,0 +1,264 @@
+/**
+ * This file contains the implementation of the size report. The pre-processor records where each macro invocation
+ * was expanded in the extended source file, and the report walks the statement list once, adding the words of each
+ * statement to the label it follows in its segment and to the expansion site it comes from.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "report.h"
+#include "utils.h"
+#include "globals.h"
+#include "optimizer.h"
+#include "symbol_structs.h"
+#include "statement_structs.h"
+
+/* Definition of a statement in the statement list (linked list) */
+struct stmt {
+    int line_num; /* The line number of the statement in the extended source file */
+    char *source; /* A copy of the source line of the statement (kept only for the listing file), or NULL */
+    char label[MAX_SYMBOL_LEN + 1]; /* The symbol defined by the statement, or an empty string */
+    statement_type type; /* The type of the statement (instruction, directive) */
+    opcode op; /* The opcode of an instruction statement */
+    directive dir; /* The directive of a directive statement */
+    char src[MAX_OPERAND_LEN + 1]; /* The source operand, or an empty string */
+    char dest[MAX_OPERAND_LEN + 1]; /* The destination operand (or the symbol of .entry/.extern), or an empty string */
+    addressing_mode src_mode; /* The addressing mode of the source operand */
+    addressing_mode dest_mode; /* The addressing mode of the destination operand */
+    int src_value; /* The number of an immediate or register source operand */
+    int dest_value; /* The number of an immediate or register destination operand */
+    unsigned int address; /* The offset of the statement in the code or data segment */
+    int word_count; /* The number of words the statement occupies in its segment */
+    int fixup_start; /* The index of the first expression fixup of the statement */
+    int fixup_count; /* The number of expression fixups of the statement */
+    boolean is_removed; /* Indicates if the statement was removed by an optimization pass */
+    boolean is_referenced; /* Indicates if the statement can be reached or referenced by the program */
+    Stmtptr alias; /* The data statement whose words a removed data statement shares, or NULL */
+    Stmtptr next; /* Pointer to the next statement in the statement list */
+};
+
+/* Definition of a macro invocation expanded by the pre-processor */
+struct expansion_site {
+    char macro_name[MAX_MCR_LEN + 1]; /* The name of the invoked macro */
+    int line_num; /* The line number of the invocation in the source file */
+    int first_line; /* The line number of the first expanded line in the extended source file */
+    int line_count; /* The number of expanded lines */
+};
+
+/* Definition of a row of the size report */
+struct size_entry {
+    char name[MAX_SYMBOL_LEN + 1]; /* The label or the macro name of the row */
+    int words; /* The number of words attributed to the row */
+    statement_type segment; /* The segment of a label */
+    int line_num; /* The line number of an expansion site in the source file */
+    int uses; /* The number of expansion sites of a macro definition */
+};
+
+static struct expansion_site *sites; /* The expansion sites of the file, in the order of the extended source file */
+static int site_count; /* The number of expansion sites */
+static int site_capacity; /* The number of expansion sites the array can hold */
+
+/**
+ * Records the expansion of a macro invocation in the extended source file.
+ *
+ * @param macro_name    The name of the invoked macro.
+ * @param line_num      The line number of the invocation in the source file.
+ * @param first_line    The line number of the first expanded line in the extended source file.
+ * @param line_count    The number of expanded lines.
+ *
+ * @remarks The nested invocations are part of the expansion of the outermost macro, so their words count for it.
+ */
+void add_expansion_site(char *macro_name, int line_num, int first_line, int line_count) {
+    struct expansion_site *new_sites;
+
+    /* Double the capacity of the expansion sites when they are full */
+    if (site_count == site_capacity) {
+        site_capacity = site_capacity ? site_capacity * 2 : SITES_INITIAL_CAPACITY;
+        new_sites = (struct expansion_site *)realloc(sites, site_capacity * sizeof(struct expansion_site));
+        if (new_sites == NULL) {
+            print_error(MEM_REALLOC_FAILED);
+            exit(1);
+        }
+        sites = new_sites;
+    }
+
+    strcpy(sites[site_count].macro_name, macro_name);
+    sites[site_count].line_num = line_num;
+    sites[site_count].first_line = first_line;
+    sites[site_count].line_count = line_count;
+    site_count++;
+}
+
+/**
+ * Frees the expansion sites recorded for the current file.
+ */
+void free_expansion_sites(void) {
+    free(sites);
+    sites = NULL;
+    site_count = 0;
+    site_capacity = 0;
+}
+
+/**
+ * Compares two rows of the size report, for sorting the rows by decreasing size.
+ *
+ * @param first     The first row.
+ * @param second    The second row.
+ *
+ * @return A negative number if the first row is larger, a positive number if it is smaller, and 0 otherwise.
+ *
+ * @remarks Rows of the same size are ordered by name, so the report does not depend on the sorting algorithm.
+ */
+int compare_size_entries(const void *first, const void *second) {
+    const Size_entry *first_entry = (const Size_entry *)first;
+    const Size_entry *second_entry = (const Size_entry *)second;
+
+    if (first_entry->words != second_entry->words) {
+        return second_entry->words - first_entry->words;
+    }
+
+    if (first_entry->line_num != second_entry->line_num) {
+        return first_entry->line_num - second_entry->line_num;
+    }
+
+    return strcmp(first_entry->name, second_entry->name);
+}
+
+/**
+ * Adds an empty row to the size report.
+ *
+ * @param entries   The rows of the report.
+ * @param count     The number of rows, incremented by the function.
+ * @param name      The label or the macro name of the row.
+ *
+ * @return The index of the new row.
+ */
+int add_size_entry(Sizeptr entries, int *count, char *name) {
+    Sizeptr entry = &entries[*count];
+
+    strcpy(entry->name, name);
+    entry->words = 0;
+    entry->segment = INSTRUCTION;
+    entry->line_num = 0;
+    entry->uses = 0;
+
+    return (*count)++;
+}
+
+/**
+ * Prints the size report of the program to the standard output.
+ * The words of each statement count for the nearest label before it in the same segment, and for the macro
+ * expansion site it comes from. The rows of each part of the report are sorted by decreasing size.
+ *
+ * @param name The name of the program, printed at the start of the report.
+ *
+ * @remarks The function uses the global variable 'stmt_table', and must run after the optimization passes, so the
+ *          removed statements are left out of the report.
+ */
+void print_size_report(char *name) {
+    Stmtptr current_stmt;
+    Sizeptr labels;
+    Sizeptr site_entries;
+    Sizeptr macros;
+    int label_count = 0;
+    int macro_count = 0;
+    int code_label = -1; /* The row of the label the code words count for, or -1 before the first one */
+    int data_label = -1; /* The row of the label the data words count for, or -1 before the first one */
+    int code_words = 0;
+    int data_words = 0;
+    int site = 0;
+    int stmt_count = 0;
+    int *current_label;
+    int i;
+    int j;
+
+    for (current_stmt = stmt_table; current_stmt != NULL; current_stmt = current_stmt->next) {
+        stmt_count++;
+    }
+
+    /* Each statement starts at most one label row, and each segment may have a row for its unlabeled words */
+    labels = (Sizeptr)malloc((stmt_count + 2) * sizeof(Size_entry));
+    site_entries = (Sizeptr)malloc((site_count + 1) * sizeof(Size_entry));
+    macros = (Sizeptr)malloc((site_count + 1) * sizeof(Size_entry));
+    if (labels == NULL || site_entries == NULL || macros == NULL) {
+        print_error(MEM_ALLOC_FAILED);
+        exit(1);
+    }
+
+    for (i = 0; i < site_count; i++) {
+        site_entries[i].words = 0;
+        strcpy(site_entries[i].name, sites[i].macro_name);
+        site_entries[i].line_num = sites[i].line_num;
+        site_entries[i].segment = INSTRUCTION;
+        site_entries[i].uses = 1;
+    }
+
+    for (current_stmt = stmt_table; current_stmt != NULL; current_stmt = current_stmt->next) {
+        if (current_stmt->is_removed || (current_stmt->type != INSTRUCTION && !is_data_stmt(current_stmt))) {
+            continue;
+        }
+
+        /* A label starts a new row of its segment, and the words before the first label get a row of their own */
+        current_label = current_stmt->type == INSTRUCTION ? &code_label : &data_label;
+        if (current_stmt->label[0] != '\0' || *current_label == -1) {
+            *current_label = add_size_entry(labels, &label_count, current_stmt->label[0] != '\0' ? current_stmt->label : "(unlabeled)");
+            labels[*current_label].segment = current_stmt->type;
+        }
+        labels[*current_label].words += current_stmt->word_count;
+
+        if (current_stmt->type == INSTRUCTION) {
+            code_words += current_stmt->word_count;
+        } else {
+            data_words += current_stmt->word_count;
+        }
+
+        /* The statements and the expansion sites are both in the order of the extended source file */
+        while (site < site_count && sites[site].first_line + sites[site].line_count <= current_stmt->line_num) {
+            site++;
+        }
+        if (site < site_count && sites[site].first_line <= current_stmt->line_num) {
+            site_entries[site].words += current_stmt->word_count;
+        }
+    }
+
+    /* Sum the expansion sites of each macro definition */
+    for (i = 0; i < site_count; i++) {
+        for (j = 0; j < macro_count && strcmp(macros[j].name, site_entries[i].name) != 0; j++);
+        if (j == macro_count) {
+            add_size_entry(macros, &macro_count, site_entries[i].name);
+        }
+        macros[j].words += site_entries[i].words;
+        macros[j].uses++;
+    }
+
+    qsort(labels, label_count, sizeof(Size_entry), compare_size_entries);
+    qsort(site_entries, site_count, sizeof(Size_entry), compare_size_entries);
+    qsort(macros, macro_count, sizeof(Size_entry), compare_size_entries);
+
+    printf("%s: Size report: %d of %d words used (code %d, data %d)\n", name, code_words + data_words, MEM_SIZE, code_words, data_words);
+
+    printf("  Labels:\n");
+    printf("    Words  Segment  Label\n");
+    for (i = 0; i < label_count; i++) {
+        printf("    %5d  %-7s  %s\n", labels[i].words, labels[i].segment == INSTRUCTION ? "code" : "data", labels[i].name);
+    }
+
+    if (site_count > 0) {
+        printf("  Macro expansion sites:\n");
+        printf("    Words  Line  Macro\n");
+        for (i = 0; i < site_count; i++) {
+            printf("    %5d  %4d  %s\n", site_entries[i].words, site_entries[i].line_num, site_entries[i].name);
+        }
+
+        printf("  Macro definitions:\n");
+        printf("    Words  Uses  Macro\n");
+        for (i = 0; i < macro_count; i++) {
+            printf("    %5d  %4d  %s\n", macros[i].words, macros[i].uses, macros[i].name);
+        }
+    }
+
+    free(labels);
+    free(site_entries);
+    free(macros);
+}
@@ -0,0 +1,27 @@
+/**
+ * This header file declares the functions of the size report. The report attributes the code and data words of the
+ * program to its labels, to the macro expansion sites and to the macro definitions, using the word counts of the
+ * statement list and the expansion sites recorded by the pre-processor.
+ */
+
+#ifndef ASM_REPORT_H
+#define ASM_REPORT_H
+
+#include "utils.h"
+#include "symbol_structs.h"
+
+#define SITES_INITIAL_CAPACITY 16
+
+/* Forward declaration of the struct size_entry */
+typedef struct size_entry Size_entry;
+
+/* Pointer to the struct size_entry */
+typedef Size_entry *Sizeptr;
+
+void add_expansion_site(char *, int, int, int);
+void free_expansion_sites(void);
+int compare_size_entries(const void *, const void *);
+int add_size_entry(Sizeptr, int *, char *);
+void print_size_report(char *);
+
+#endif
@@ -1,6 +1,6 @@
 /**
  * This file contains the implementation of the second pass of a two-pass assembly processing for a source file.
- * It includes functions to parse and process each line of the source file during the second pass,
+ * It includes functions to process each statement collected by the first pass during the second pass,
  * as well as functions to encode operands, symbols, and operations into the assembly code.
  */
 
@@ -9,7 +9,9 @@
 #include "second_pass.h"
 #include "utils.h"
 #include "globals.h"
+#include "output_files.h"
 #include "symbol_structs.h"
+#include "statement_structs.h"
 
 /* Definition of a symbol in the symbol table (linked list) */
 struct symbol {
@@ -21,217 +23,162 @@ struct symbol {
     Symbolptr next; /* Pointer to the next symbol in the symbol table */
 };
 
+/* Definition of a statement in the statement list (linked list) */
+struct stmt {
+    int line_num; /* The line number of the statement in the extended source file */
+    char *source; /* A copy of the source line of the statement (kept only for the listing file), or NULL */
+    char label[MAX_SYMBOL_LEN + 1]; /* The symbol defined by the statement, or an empty string */
+    statement_type type; /* The type of the statement (instruction, directive) */
+    opcode op; /* The opcode of an instruction statement */
+    directive dir; /* The directive of a directive statement */
+    char src[MAX_OPERAND_LEN + 1]; /* The source operand, or an empty string */
+    char dest[MAX_OPERAND_LEN + 1]; /* The destination operand (or the symbol of .entry/.extern), or an empty string */
+    addressing_mode src_mode; /* The addressing mode of the source operand */
+    addressing_mode dest_mode; /* The addressing mode of the destination operand */
+    int src_value; /* The number of an immediate or register source operand */
+    int dest_value; /* The number of an immediate or register destination operand */
+    unsigned int address; /* The offset of the statement in the code or data segment */
+    int word_count; /* The number of words the statement occupies in its segment */
+    int fixup_start; /* The index of the first expression fixup of the statement */
+    int fixup_count; /* The number of expression fixups of the statement */
+    boolean is_removed; /* Indicates if the statement was removed by an optimization pass */
+    boolean is_referenced; /* Indicates if the statement can be reached or referenced by the program */
+    Stmtptr alias; /* The data statement whose words a removed data statement shares, or NULL */
+    Stmtptr next; /* Pointer to the next statement in the statement list */
+};
+
 /**
- * Performs the second pass of a two-pass processing on a source file.
- *
- * @param source_filename The name of the source file to process.
+ * Performs the second pass of a two-pass processing on the statements collected by the first pass.
  *
  * @return A boolean indicating whether there were any errors during processing.
  *
- * @remarks This function relies on the global variables ic and line_num for processing.
+ * @remarks This function relies on the global variables stmt_table, ic, line_num and listing_fd for processing.
+ *          Statements removed by an optimization pass are skipped.
  */
-boolean second_process(char *source_filename) {
-    char *modified_filename_macro;
-    char line[MAX_LINE_LEN]; /* Buffer to store each line of the source file */
-    FILE *extended_src_fd;
+boolean second_process(void) {
+    Stmtptr current_stmt;
     boolean was_error;
+    int code_size = ic; /* The size of the code segment, which is followed by the data segment */
 
     ic = 0;
-    line_num = 1;
     ext_table = NULL;
 
     was_error = FALSE; /* Flag to track if there were any errors during processing */
 
-    /* Generate a modified filename with a macro extension */
-    modified_filename_macro = generate_new_filename(source_filename, FILE_MACRO);
+    /* Process each statement recorded by the first pass */
+    for (current_stmt = stmt_table; current_stmt != NULL; current_stmt = current_stmt->next) {
+        if (current_stmt->is_removed) {
+            continue;
+        }
 
-    extended_src_fd = fopen(modified_filename_macro, "r");
-    if (extended_src_fd == NULL) {
-        print_error(CANNOT_OPEN_FILE);
-        free(modified_filename_macro);
-        return TRUE;
-    }
+        /* Report errors with the line number the statement came from */
+        line_num = current_stmt->line_num;
 
-    /* Read each line from the extended source file and process it */
-    while (fgets(line, MAX_LINE_LEN, extended_src_fd)) {
-        /* Trim leading and trailing whitespaces from the line before processing */
-        trim_whitespaces(line);
-        /* Check if the line should be ignored */
-        if (!should_ignore(line)) {
-            /* Parse and process the line in the second pass */
-            if (!parse_line_second_pass(line)) {
-                was_error = TRUE;
-            }
+        /* Process the statement in the second pass */
+        if (!process_stmt_second_pass(current_stmt)) {
+            was_error = TRUE;
         }
 
-        line_num++;
+        /* Write the encoded words of the statement to the listing file while they are at hand */
+        if (listing_fd != NULL) {
+            write_listing_stmt(current_stmt, code_size);
+        }
     }
 
-    free(modified_filename_macro);
-
-    fclose(extended_src_fd);
-
     return was_error;
 }
 
 /**
- * Parses and processes a line during the second pass of assembly processing.
+ * Writes the rows of a statement to the listing file: a row for each word of the statement, the first one with the
+ * source line, or a single row with the source line for a statement without words.
  *
- * @param line The line to parse and process.
+ * @param stmt      The statement.
+ * @param code_size The size of the code segment, which is followed by the data segment.
  *
- * @return A boolean indicating whether the line was successfully parsed and processed.
+ * @remarks The function uses the global variables 'listing_fd', 'code' and 'data'.
  */
-boolean parse_line_second_pass(char *line) {
-    opcode op_val = NONE_OP;
-    directive dir_val = NONE_DIR;
-    char current_token[MAX_LINE_LEN];
-
-    /* Extract the next token from the line, which could be a symbol or an operation/directive */
-    copy_next_token(current_token, line, ":\t ");
-
-    /* If the token is a symbol, skip it */
-    if (is_symbol(current_token, TRUE)) {
-        line = extract_remaining_seq(line, ":");
-        copy_next_token(current_token, line, ",\t ");
+void write_listing_stmt(Stmtptr stmt, int code_size) {
+    unsigned int *words = stmt->type == INSTRUCTION ? code + stmt->address : data + stmt->address;
+    int address = MEM_START + (stmt->type == INSTRUCTION ? 0 : code_size) + stmt->address;
+    int i;
+
+    if (stmt->word_count == 0) {
+        write_listing_line(listing_fd, -1, 0, stmt->source);
+        return;
     }
 
-    /* Check if the token corresponds to an operation */
-    if ((op_val = find_operation(current_token)) != NONE_OP) {
-        line = extract_remaining_seq(line, ",\t ");
-
-        /* If the second pass processing of the operation fails, return false */
-        return process_operation_second_pass(op_val, line);
-    /* Check if the token corresponds to a directive */
-    } else if ((dir_val = find_directive(current_token)) != NONE_DIR) {
-        line = extract_remaining_seq(line, ",\t ");
-        if (dir_val == ENTRY) {
-            /* Extract the symbol token after the ENTRY directive and make it an entry symbol */
-            copy_next_token(current_token, line, "\t ");
-            return make_entry(symbol_table, current_token);
-        }
+    for (i = 0; i < stmt->word_count; i++) {
+        write_listing_line(listing_fd, address + i, words[i], i == 0 ? stmt->source : NULL);
     }
-
-    return TRUE;
 }
 
 /**
- * Processes an operation during the second pass of assembly processing.
+ * Processes a statement during the second pass of assembly processing.
  *
- * @param op_type   The opcode representing the operation to process.
- * @param line      The line containing the operation and its operands.
+ * @param stmt The statement to process.
  *
- * @return A boolean indicating whether the operation was successfully processed.
+ * @return A boolean indicating whether the statement was successfully processed.
  */
-boolean process_operation_second_pass(opcode op_type, char *line) {
-    boolean has_src = FALSE, has_dest = FALSE;
-    addressing_mode src_addr_mode = NONE_ADDR, dest_addr_mode = NONE_ADDR;
-    char src[MAX_OPERAND_LEN];
-    char dest[MAX_OPERAND_LEN];
-
-    /* Determine if the operation has source and destination operands */
-    determine_operand(op_type, &has_src, &has_dest);
-
-    /* Extract addressing mode for the source operand if it exists */
-    if (has_src) {
-        src_addr_mode = (addressing_mode)extract_bits(code[ic], SRC_MODE_START_POS, SRC_MODE_END_POS);
+boolean process_stmt_second_pass(Stmtptr stmt) {
+    /* Encode the additional words of an operation */
+    if (stmt->type == INSTRUCTION) {
+        return process_operation_second_pass(stmt);
     }
 
-    /* Extract addressing mode for the destination operand if it exists */
-    if (has_dest) {
-        dest_addr_mode = (addressing_mode)extract_bits(code[ic], DEST_MODE_START_POS, DEST_MODE_END_POS);
-    }
-
-    /* Extract source and destination operands from the line */
-    if (has_dest) {
-        if (has_src) {
-            copy_next_token(src, line, ",\t ");
-            line = extract_remaining_seq(line, ",\t ");
-            line++; /* Skip comma */
-            copy_next_token(dest, line, "\t ");
-        } else {
-            copy_next_token(dest, line, "\t ");
-        }
+    /* Make the symbol of an ENTRY directive an entry symbol */
+    if (stmt->dir == ENTRY) {
+        return make_entry(symbol_table, stmt->dest);
     }
 
-    ic++;
-
-    /* Encode additional words based on the extracted operands and addressing modes */
-    return encode_additional_words(src, dest, has_src, has_dest, src_addr_mode, dest_addr_mode);
+    return TRUE;
 }
 
 /**
- * Determines the presence of source and destination operands for the given opcode.
+ * Processes an operation during the second pass of assembly processing.
+ *
+ * @param stmt The statement holding the operation, its operands and their addressing modes.
+ *
+ * @return A boolean indicating whether the operation was successfully processed.
  *
- * @param op_type   The opcode for which to determine the operands.
- * @param has_src   Pointer to a boolean indicating if the opcode has a source operand.
- * @param has_dest  Pointer to a boolean indicating if the opcode has a destination operand.
+ * @remarks The function sets the global variable 'ic' to the address of the operation's first word.
  */
-void determine_operand(opcode op_type, boolean *has_src, boolean *has_dest) {
-    switch (op_type)
-    {
-        case MOV_OP:
-        case CMP_OP:
-        case ADD_OP:
-        case SUB_OP:
-        case LEA_OP:
-            *has_src = TRUE;
-            *has_dest = TRUE;
-            break;
-
-        case NOT_OP:
-        case CLR_OP:
-        case INC_OP:
-        case DEC_OP:
-        case JMP_OP:
-        case BNE_OP:
-        case RED_OP:
-        case PRN_OP:
-        case JSR_OP:
-            *has_src = FALSE;
-            *has_dest = TRUE;
-            break;
-
-        case RTS_OP:
-        case STOP_OP:
-            *has_src = FALSE;
-            *has_dest = FALSE;
+boolean process_operation_second_pass(Stmtptr stmt) {
+    /* Skip the first word, which was already encoded in the first pass */
+    ic = stmt->address;
+    ic++;
 
-        default:
-            break;
-    }
+    /* Encode additional words based on the operands and addressing modes */
+    return encode_additional_words(stmt);
 }
 
 /**
  * Encodes additional words based on the source and destination operands and their addressing modes.
  *
- * @param src       The source operand.
- * @param dest      The destination operand.
- * @param has_src   Indicates whether the opcode has a source operand.
- * @param has_dest  Indicates whether the opcode has a destination operand.
- * @param src_mode  The addressing mode of the source operand.
- * @param dest_mode The addressing mode of the destination operand.
+ * @param stmt The statement holding the operands, their addressing modes and the numbers of immediate or register operands.
  *
  * @return A boolean indicating whether the encoding of additional words was successful.
  */
-boolean encode_additional_words(char *src, char *dest, boolean has_src, boolean has_dest, addressing_mode src_mode, addressing_mode dest_mode) {
+boolean encode_additional_words(Stmtptr stmt) {
     boolean src_success = FALSE, dest_success = FALSE;
+    boolean has_src = stmt->src_mode != NONE_ADDR;
+    boolean has_dest = stmt->dest_mode != NONE_ADDR;
 
-    if (has_src && has_dest && src_mode == REG_DIRECT_ADDR && dest_mode == REG_DIRECT_ADDR) {
+    if (has_src && has_dest && stmt->src_mode == REG_DIRECT_ADDR && stmt->dest_mode == REG_DIRECT_ADDR) {
         /* If both source and destination are registers, encode their values as a single word */
-        append_word_to_code(encode_reg(src, FALSE) | encode_reg(dest, TRUE));
+        append_word_to_code(encode_reg(stmt->src_value, FALSE) | encode_reg(stmt->dest_value, TRUE));
         return TRUE;
     }
 
     if (has_dest) {
         if (has_src) {
             /* Encode the source operand to code based on its addressing mode */
-            src_success = encode_operand_to_code(src, src_mode, FALSE);
+            src_success = encode_operand_to_code(stmt->src, stmt->src_value, stmt->src_mode, FALSE);
             /* Encode the destination operand to code based on its addressing mode */
-            dest_success = encode_operand_to_code(dest, dest_mode, TRUE);
+            dest_success = encode_operand_to_code(stmt->dest, stmt->dest_value, stmt->dest_mode, TRUE);
             return dest_success && src_success;
         }
         /* Encode the destination operand to code based on its addressing mode */
-        dest_success = encode_operand_to_code(dest, dest_mode, TRUE);
+        dest_success = encode_operand_to_code(stmt->dest, stmt->dest_value, stmt->dest_mode, TRUE);
         return dest_success;
     }
 
@@ -241,14 +188,13 @@ boolean encode_additional_words(char *src, char *dest, boolean has_src, boolean
 /**
  * Encodes a register value into a word for use in the assembly code.
  *
- * @param reg       The register value to encode.
- * @param is_dest   Indicates whether the register is used as a destination operand.
+ * @param register_num  The register number to encode.
+ * @param is_dest       Indicates whether the register is used as a destination operand.
  *
  * @return The encoded word representing the register value.
  */
-unsigned int encode_reg(char *reg, boolean is_dest) {
+unsigned int encode_reg(int register_num, boolean is_dest) {
     unsigned int word = 0;
-    int register_num = atoi(reg + SKIP_TO_NUM_REG); /* Skip '@' and 'r' characters to extract the register number */
 
     if (!is_dest) {
         /* Shift the register number to the left by the number of bits in a register */
@@ -267,19 +213,19 @@ unsigned int encode_reg(char *reg, boolean is_dest) {
  * Encodes an operand into the assembly code based on its addressing mode.
  *
  * @param operand   The operand to encode.
+ * @param value     The number of an immediate operand or the register number of a register operand.
  * @param addr_mode The addressing mode of the operand.
  * @param is_dest   A boolean indicating whether the operand is a destination operand.
  *
  * @return A boolean indicating whether the encoding of the operand was successful.
  */
-boolean encode_operand_to_code(char *operand, addressing_mode addr_mode, boolean is_dest) {
+boolean encode_operand_to_code(char *operand, int value, addressing_mode addr_mode, boolean is_dest) {
     unsigned int word = 0;
 
     switch (addr_mode) {
         case IMMEDIATE_ADDR:
-            /* Convert the operand to an integer and encode it as an absolute value */
-            word = atoi(operand);
-            word = encode_are(word, ABSOLUTE);
+            /* Encode the number as an absolute value */
+            word = encode_are(value, ABSOLUTE);
             append_word_to_code(word);
             return TRUE;
 
@@ -289,7 +235,7 @@ boolean encode_operand_to_code(char *operand, addressing_mode addr_mode, boolean
 
         case REG_DIRECT_ADDR:
             /* Encode the operand as a register value */
-            word = encode_reg(operand, is_dest);
+            word = encode_reg(value, is_dest);
             append_word_to_code(word);
             return TRUE;
 
@@ -8,21 +8,21 @@
 #define ASM_SECOND_PASS_H
 
 #include "utils.h"
+#include "statement_structs.h"
 
 #define SRC_MODE_START_POS 9
 #define SRC_MODE_END_POS 11
 #define DEST_MODE_START_POS 2
 #define DEST_MODE_END_POS 4
 #define BITS_IN_REG 5
-#define SKIP_TO_NUM_REG 2
 
-boolean second_process(char *);
-boolean parse_line_second_pass(char *);
-boolean process_operation_second_pass(opcode, char *);
-void determine_operand(opcode, boolean *, boolean *);
-boolean encode_additional_words(char *, char *, boolean, boolean, addressing_mode, addressing_mode);
-unsigned int encode_reg(char *, boolean);
-boolean encode_operand_to_code(char *, addressing_mode, boolean);
+boolean second_process(void);
+void write_listing_stmt(Stmtptr, int);
+boolean process_stmt_second_pass(Stmtptr);
+boolean process_operation_second_pass(Stmtptr);
+boolean encode_additional_words(Stmtptr);
+unsigned int encode_reg(int, boolean);
+boolean encode_operand_to_code(char *, int, addressing_mode, boolean);
 boolean encode_symbol(char *);
 
 #endif
\ No newline at end of file
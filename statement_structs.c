@@ -0,0 +1,152 @@
+/**
+ * This file contains the implementation of the functions related to the statement list of an assembly language
+ * program. The statement list is the intermediate representation built by the first pass: each node describes a
+ * single instruction or directive, its operands and its place in the code or data segment.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "statement_structs.h"
+#include "utils.h"
+#include "globals.h"
+#include "expression.h"
+
+/* Definition of a statement in the statement list (linked list) */
+struct stmt {
+    int line_num; /* The line number of the statement in the extended source file */
+    char *source; /* A copy of the source line of the statement (kept only for the listing file), or NULL */
+    char label[MAX_SYMBOL_LEN + 1]; /* The symbol defined by the statement, or an empty string */
+    statement_type type; /* The type of the statement (instruction, directive) */
+    opcode op; /* The opcode of an instruction statement */
+    directive dir; /* The directive of a directive statement */
+    char src[MAX_OPERAND_LEN + 1]; /* The source operand, or an empty string */
+    char dest[MAX_OPERAND_LEN + 1]; /* The destination operand (or the symbol of .entry/.extern), or an empty string */
+    addressing_mode src_mode; /* The addressing mode of the source operand */
+    addressing_mode dest_mode; /* The addressing mode of the destination operand */
+    int src_value; /* The number of an immediate or register source operand */
+    int dest_value; /* The number of an immediate or register destination operand */
+    unsigned int address; /* The offset of the statement in the code or data segment */
+    int word_count; /* The number of words the statement occupies in its segment */
+    int fixup_start; /* The index of the first expression fixup of the statement */
+    int fixup_count; /* The number of expression fixups of the statement */
+    boolean is_removed; /* Indicates if the statement was removed by an optimization pass */
+    boolean is_referenced; /* Indicates if the statement can be reached or referenced by the program */
+    Stmtptr alias; /* The data statement whose words a removed data statement shares, or NULL */
+    Stmtptr next; /* Pointer to the next statement in the statement list */
+};
+
+/**
+ * Initializes a statement with default values.
+ *
+ * @param stmt  The statement to initialize.
+ * @param type  The type of the statement (instruction, directive).
+ *
+ * @remarks The function uses the global variable 'line_num' as the line number of the statement.
+ */
+void init_stmt(Stmtptr stmt, statement_type type) {
+    stmt->line_num = line_num;
+    stmt->source = NULL;
+    stmt->label[0] = '\0';
+    stmt->type = type;
+    stmt->op = NONE_OP;
+    stmt->dir = NONE_DIR;
+    stmt->src[0] = '\0';
+    stmt->dest[0] = '\0';
+    stmt->src_mode = NONE_ADDR;
+    stmt->dest_mode = NONE_ADDR;
+    stmt->src_value = 0;
+    stmt->dest_value = 0;
+    stmt->address = 0;
+    stmt->word_count = 0;
+    stmt->fixup_start = get_fixup_count();
+    stmt->fixup_count = 0;
+    stmt->is_removed = FALSE;
+    stmt->is_referenced = FALSE;
+    stmt->alias = NULL;
+    stmt->next = NULL;
+}
+
+/**
+ * Keeps a copy of the source line of a statement.
+ *
+ * @param stmt  The statement.
+ * @param line  The source line of the statement.
+ */
+void set_stmt_source(Stmtptr stmt, char *line) {
+    stmt->source = (char *)malloc((strlen(line) + 1) * sizeof(char));
+    if (stmt->source == NULL) {
+        print_error(MEM_ALLOC_FAILED);
+        exit(1);
+    }
+
+    strcpy(stmt->source, line);
+}
+
+/**
+ * Adds a copy of the given statement to the end of the statement list.
+ *
+ * @param head  A pointer to the head of the statement list.
+ * @param stmt  The statement to copy into the list.
+ *
+ * @return A pointer to the newly added statement.
+ */
+Stmtptr add_stmt_to_list(Stmtptr *head, Stmtptr stmt) {
+    Stmtptr new_stmt = (Stmtptr)malloc(sizeof(Stmt));
+    if (new_stmt == NULL) {
+        print_error(MEM_ALLOC_FAILED);
+        exit(1);
+    }
+
+    /* Copy the statement and detach the copy from any list */
+    *new_stmt = *stmt;
+    new_stmt->next = NULL;
+
+    if (*head == NULL) {
+        /* If the list is empty, make the new statement the head */
+        *head = new_stmt;
+    } else {
+        /* Traverse the list to find the last statement */
+        Stmtptr current = *head;
+        while (current->next != NULL) {
+            current = current->next;
+        }
+
+        /* Add the new statement to the end of the list */
+        current->next = new_stmt;
+    }
+
+    return new_stmt;
+}
+
+/**
+ * Frees the memory occupied by the statement list.
+ *
+ * @param head A pointer to the head pointer of the statement list.
+ */
+void free_stmt(Stmtptr *head) {
+    Stmtptr current;
+    Stmtptr next;
+
+    /* Nothing to free if the statement list is empty */
+    if (*head == NULL) {
+        return;
+    }
+
+    current = *head;
+
+    /* Traverse the statement list and free each statement */
+    while (current != NULL) {
+        /* Store the next statement before freeing the current statement */
+        next = current->next;
+
+        /* Free the memory occupied by the current statement and its source line */
+        free(current->source);
+        free(current);
+
+        /* Move to the next statement */
+        current = next;
+    }
+
+    /* Set the head pointer to NULL to indicate an empty statement list */
+    *head = NULL;
+}
\ No newline at end of file
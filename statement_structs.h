@@ -0,0 +1,24 @@
+/**
+ * This header file contains the declarations of the data structures and functions related to the statement list
+ * in the assembler. The statement list is built during the first pass and holds every successfully parsed statement,
+ * so the optimization passes and the second pass can work on it without parsing the source file again.
+ */
+
+#ifndef ASM_STATEMENT_STRUCTS_H
+#define ASM_STATEMENT_STRUCTS_H
+
+#include "utils.h"
+#include "symbol_structs.h"
+
+/* Forward declaration of the struct stmt */
+typedef struct stmt Stmt;
+
+/* Pointer to the struct stmt */
+typedef Stmt *Stmtptr;
+
+void init_stmt(Stmtptr, statement_type);
+void set_stmt_source(Stmtptr, char *);
+Stmtptr add_stmt_to_list(Stmtptr *, Stmtptr);
+void free_stmt(Stmtptr *);
+
+#endif
\ No newline at end of file
@@ -51,6 +51,23 @@ void update_symbol_addr(Symbolptr table, unsigned int addr_inc, statement_type t
     }
 }
 
+/**
+ * Sets the address of a symbol in the symbol table.
+ *
+ * @param head      The head of the symbol table.
+ * @param name      The name of the symbol to set the address for.
+ * @param address   The new address of the symbol.
+ */
+void set_symbol_addr(Symbolptr head, char *name, unsigned int address) {
+    /* Find the symbol in the symbol table */
+    Symbolptr symbol = find_symbol(head, name);
+
+    /* If the symbol is found, update its address */
+    if (symbol != NULL) {
+        symbol->address = address;
+    }
+}
+
 /**
  * Makes a symbol an entry symbol.
  *
@@ -24,6 +24,7 @@ typedef Ext *Extptr;
 typedef enum statement_type { INSTRUCTION, DIRECTIVE } statement_type;
 
 void update_symbol_addr(Symbolptr, unsigned int, statement_type);
+void set_symbol_addr(Symbolptr, char *, unsigned int);
 boolean make_entry(Symbolptr, char *);
 unsigned int get_symbol_addr(Symbolptr, char *);
 boolean is_extern_symbol(Symbolptr, char *);
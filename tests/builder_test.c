@@ -0,0 +1,156 @@
+/**
+ * This file contains a test program for the builder API. It builds a program with begin_program, the emit functions
+ * and end_program, assembles the same program written in the source language with the text front end, and checks
+ * that both produce the same output files.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "../utils.h"
+#include "../globals.h"
+#include "../builder.h"
+#include "../assembler.h"
+
+/* The program built by the test, in the source language */
+static char *text_program =
+    ".extern EXT\n"
+    ".entry MAIN\n"
+    "MAIN: mov @r1,@r2\n"
+    "LOOP: add NUMS,@r3\n"
+    "jsr EXT\n"
+    "prn -5\n"
+    "bne LOOP\n"
+    "stop\n"
+    "NUMS: .data 7,-57,17\n"
+    "STR: .string \"abc\"\n";
+
+/**
+ * Builds the test program with the builder API.
+ *
+ * @param name The base name of the output files.
+ *
+ * @return TRUE if the program was built and assembled without errors, FALSE otherwise.
+ */
+boolean build_program(char *name) {
+    int values[3];
+
+    values[0] = 7;
+    values[1] = -57;
+    values[2] = 17;
+
+    begin_program();
+    declare_extern("EXT");
+    declare_entry("MAIN");
+    emit_label("MAIN");
+    emit_op(MOV_OP, "@r1", "@r2");
+    emit_label("LOOP");
+    emit_op(ADD_OP, "NUMS", "@r3");
+    emit_op(JSR_OP, "EXT", NULL);
+    emit_op(PRN_OP, "-5", NULL);
+    emit_op(BNE_OP, "LOOP", NULL);
+    emit_op(STOP_OP, NULL, NULL);
+    emit_label("NUMS");
+    emit_data(values, 3);
+    emit_label("STR");
+    emit_string("abc");
+
+    return !end_program(name);
+}
+
+/**
+ * Writes the test program in the source language to a .as file.
+ *
+ * @param name The name of the source file (without an extension).
+ *
+ * @return TRUE if the file was written, FALSE otherwise.
+ */
+boolean write_text_program(char *name) {
+    char filename[MAX_LINE_LEN];
+    FILE *source_fd;
+
+    sprintf(filename, "%s.as", name);
+    source_fd = fopen(filename, "w");
+    if (source_fd == NULL) {
+        return FALSE;
+    }
+
+    fputs(text_program, source_fd);
+
+    return fclose(source_fd) == 0;
+}
+
+/**
+ * Compares an output file of the built program with the same output file of the assembled source.
+ *
+ * @param extension The extension of the output file (e.g. ".ob").
+ *
+ * @return TRUE if both files exist and have the same contents, FALSE otherwise.
+ */
+boolean compare_outputs(char *extension) {
+    char filename[MAX_LINE_LEN];
+    FILE *built_fd;
+    FILE *text_fd;
+    int built_char;
+    int text_char;
+
+    sprintf(filename, "built%s", extension);
+    built_fd = fopen(filename, "r");
+    sprintf(filename, "text%s", extension);
+    text_fd = fopen(filename, "r");
+
+    if (built_fd == NULL || text_fd == NULL) {
+        printf("Missing %s output file\n", extension);
+        if (built_fd != NULL) {
+            fclose(built_fd);
+        }
+        if (text_fd != NULL) {
+            fclose(text_fd);
+        }
+        return FALSE;
+    }
+
+    do {
+        built_char = fgetc(built_fd);
+        text_char = fgetc(text_fd);
+    } while (built_char == text_char && built_char != EOF);
+
+    fclose(built_fd);
+    fclose(text_fd);
+
+    if (built_char != text_char) {
+        printf("The %s output files differ\n", extension);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * The main entry point of the test program.
+ *
+ * @return 0 if the built program matches the assembled source, 1 otherwise.
+ */
+int main(void) {
+    boolean success = TRUE;
+
+    if (!build_program("built")) {
+        printf("Building the program failed\n");
+        return 1;
+    }
+
+    if (!write_text_program("text")) {
+        printf("Writing the source file failed\n");
+        return 1;
+    }
+    assemble_source("text");
+
+    success = compare_outputs(".ob") && success;
+    success = compare_outputs(".ent") && success;
+    success = compare_outputs(".ext") && success;
+
+    if (success) {
+        printf("The built program matches the assembled source\n");
+    }
+
+    return success ? 0 : 1;
+}
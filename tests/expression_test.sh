@@ -0,0 +1,110 @@
+#!/bin/sh
+# Checks the folded expressions of small programs: each program is assembled together with a program that spells out
+# the expected numbers, and the object files are compared, and the programs whose expressions are invalid are checked
+# to fail with the expected message.
+#
+# Usage: expression_test.sh <asm executable> <scratch directory>
+
+ASM=$1
+WORK=$2
+status=0
+
+rm -rf "$WORK" && mkdir -p "$WORK" || exit 1
+
+# Writes a source file from the standard input
+write_source() {
+    cat > "$WORK/$1.as"
+}
+
+# Checks that a program has the object file of the expected program
+check_folded() {
+    (cd "$WORK" && "$ASM" "$1" > "$1.txt" && "$ASM" "$2" > "$2.txt")
+
+    if ! cmp -s "$WORK/$1.ob" "$WORK/$2.ob"; then
+        echo "$1: the expressions were not folded to the numbers of $2"
+        status=1
+    fi
+}
+
+# Checks that a program is rejected with the expected error message
+check_error() {
+    (cd "$WORK" && "$ASM" "$1" > "$1.txt")
+
+    if ! grep -qF "$2" "$WORK/$1.txt" || [ -f "$WORK/$1.ob" ]; then
+        echo "$1: expected the error \"$2\""
+        status=1
+    fi
+}
+
+# Constants, precedence, parentheses, integer division and the bounds of the values
+write_source arithmetic <<'SOURCE'
+.equ N, 7
+.set M, N*2
+MAIN: prn 3+4*2
+prn (3+4)*2
+prn M-N/2
+prn -(N+1)
+stop
+.data M, 100/N, 32766+1, -32766-1
+SOURCE
+write_source arithmetic_expected <<'SOURCE'
+MAIN: prn 11
+prn 14
+prn 11
+prn -8
+stop
+.data 14, 14, 32767, -32767
+SOURCE
+check_folded arithmetic arithmetic_expected
+
+# A difference of labels is the distance between them, in either segment
+write_source difference <<'SOURCE'
+START: prn END-START
+prn S2-S1
+END: stop
+S1: .string "abc"
+S2: .data END-START
+SOURCE
+write_source difference_expected <<'SOURCE'
+START: prn 4
+prn 4
+END: stop
+S1: .string "abc"
+S2: .data 4
+SOURCE
+check_folded difference difference_expected
+
+write_source too_large <<'SOURCE'
+MAIN: prn 32767+1
+stop
+SOURCE
+check_error too_large "Expression value is out of range (-32767 to 32767)"
+
+write_source too_small <<'SOURCE'
+MAIN: prn -32767-1
+stop
+SOURCE
+check_error too_small "Expression value is out of range (-32767 to 32767)"
+
+write_source zero_constant <<'SOURCE'
+.equ Z, 5/0
+MAIN: stop
+SOURCE
+check_error zero_constant "Division by zero in expression"
+
+write_source zero_immediate <<'SOURCE'
+MAIN: prn 4/(2-2)
+stop
+SOURCE
+check_error zero_immediate "Division by zero in expression"
+
+# The address of TBL is only known when the program is loaded, so TBL+1 cannot be an immediate
+write_source relocatable <<'SOURCE'
+MAIN: add TBL+1,@r2
+stop
+TBL: .data 1, 2
+SOURCE
+check_error relocatable "Immediate expression can only use labels in differences of addresses"
+
+[ $status -eq 0 ] && echo "The expressions were folded as expected"
+exit $status
@@ -0,0 +1,133 @@
+#!/bin/sh
+# Checks that the optional optimization passes keep the meaning of small programs: each program is assembled with and
+# without a pass, and the object files are compared where the pass must not change them.
+#
+# Usage: passes_test.sh <asm executable> <scratch directory>
+
+ASM=$1
+WORK=$2
+status=0
+
+rm -rf "$WORK" && mkdir -p "$WORK/plain" "$WORK/optimized" || exit 1
+
+# Writes a source file from the standard input into both directories
+write_source() {
+    cat > "$WORK/plain/$1.as"
+    cp "$WORK/plain/$1.as" "$WORK/optimized/$1.as"
+}
+
+# Checks that a pass turns the object file of a program into the object file of the expected program
+check_result() {
+    (cd "$WORK/optimized" && "$ASM" "$2" "$1" > "$1.txt")
+    (cd "$WORK/plain" && "$ASM" "$3" > "$3.txt")
+
+    if ! cmp -s "$WORK/optimized/$1.ob" "$WORK/plain/$3.ob"; then
+        echo "$1: $2 did not produce the object file of $3"
+        status=1
+    fi
+}
+
+# Checks that a pass leaves the object file of a program unchanged
+check_same() {
+    (cd "$WORK/plain" && "$ASM" "$1" > "$1.txt")
+    (cd "$WORK/optimized" && "$ASM" "$2" "$1" > "$1.txt")
+
+    if ! cmp -s "$WORK/plain/$1.ob" "$WORK/optimized/$1.ob"; then
+        echo "$1: $2 changed the object file"
+        status=1
+    fi
+}
+
+# -O removes the move onto itself, the addition of 0, the move back and the jump to the next instruction
+write_source peephole <<'SOURCE'
+MAIN: mov @r1,@r1
+add 0,@r2
+mov @r3,@r4
+mov @r4,@r3
+jmp NEXT
+NEXT: prn @r2
+stop
+SOURCE
+write_source peephole_expected <<'SOURCE'
+MAIN: mov @r3,@r4
+NEXT: prn @r2
+stop
+SOURCE
+check_result peephole -O peephole_expected
+
+# The instructions between START and END are kept under -O, so END-START keeps its value
+write_source peephole_difference <<'SOURCE'
+START: mov @r1,@r1
+add 0,@r2
+prn END-START
+END: stop
+SOURCE
+check_same peephole_difference -O
+
+# -U removes the instruction no jump reaches and the data no instruction uses
+write_source unreachable <<'SOURCE'
+MAIN: prn USED
+jmp END
+dec @r2
+END: stop
+UNUSED: .data 7
+USED: .data 8
+SOURCE
+write_source unreachable_expected <<'SOURCE'
+MAIN: prn USED
+jmp END
+END: stop
+USED: .data 8
+SOURCE
+check_result unreachable -U unreachable_expected
+
+# A jump through a register can reach any instruction, so -U keeps the instruction after stop
+write_source register_jump <<'SOURCE'
+MAIN: jmp @r1
+stop
+dec @r2
+SOURCE
+check_same register_jump -U
+
+# B is not used, but it lies between the labels of C-A, so -U keeps it
+write_source unreachable_difference <<'SOURCE'
+MAIN: prn C-A
+stop
+A: .data 1
+B: .data 2
+C: .data 3
+SOURCE
+check_same unreachable_difference -U
+
+# -M makes S2 an alias of S1, which has the same words
+write_source merge <<'SOURCE'
+MAIN: prn S1
+prn S2
+stop
+S1: .string "ab"
+S2: .string "ab"
+SOURCE
+write_source merge_expected <<'SOURCE'
+MAIN: prn S1
+prn S1
+stop
+S1: .string "ab"
+SOURCE
+check_result merge -M merge_expected
+
+# The label differences keep their values under -M: S2 and S3 have the words of S1, but S2 is used by an expression
+# and S3 lies between the labels of another one, so no block is merged
+write_source merge_difference <<'SOURCE'
+S1: .string "ab"
+S2: .string "ab"
+T1: .data 5
+S3: .string "ab"
+T2: .data 5
+MAIN: prn S2-S1
+prn T2-T1
+stop
+SOURCE
+check_same merge_difference -M
+
+[ $status -eq 0 ] && echo "The optimization passes kept the meaning of the programs"
+exit $status
@@ -0,0 +1,79 @@
+#!/bin/sh
+# Checks that assembling with -P gives the same output and files as assembling serially, while a worker process is
+# killed, or stopped, in the middle of its shard. The sources are copies of the test files, listed in an input
+# manifest.
+#
+# Usage: shard_test.sh <asm executable> <directory of the .as test files> <scratch directory>
+
+ASM=$1
+SOURCES=$2
+WORK=$3
+COPIES=60
+
+rm -rf "$WORK" && mkdir -p "$WORK/sources" || exit 1
+
+# Make enough shards to keep every worker busy, and list them in the manifest
+for source in "$SOURCES"/*.as; do
+    base=$(basename "$source" .as)
+    i=1
+    while [ $i -le $COPIES ]; do
+        cp "$source" "$WORK/sources/$base-$i.as"
+        echo "$base-$i" >> "$WORK/manifest.txt"
+        i=$((i + 1))
+    done
+done
+
+cp -r "$WORK/sources" "$WORK/serial" || exit 1
+(cd "$WORK/serial" && "$ASM" "-I$WORK/manifest.txt" > "$WORK/serial.txt")
+
+status=0
+
+# Runs the coordinator with a deadline of one second per shard, sends a signal to the first worker it forks that has
+# the files of a shard in its scratch directory, and compares the output and the files with the serial run
+check_signaled_worker() {
+    rm -rf "$WORK/parallel" "$WORK/tmp" && mkdir -p "$WORK/tmp" && cp -r "$WORK/sources" "$WORK/parallel" || exit 1
+
+    (cd "$WORK/parallel" && TMPDIR="$WORK/tmp" exec "$ASM" -P4 -T1 "-I$WORK/manifest.txt" > "$WORK/parallel.txt") &
+    coordinator=$!
+    signaled=
+    while [ -z "$signaled" ] && kill -0 $coordinator 2>/dev/null; do
+        for worker in $(ps -o pid= --ppid $coordinator); do
+            if [ -n "$(ls "$WORK/tmp/asm-worker-$worker" 2>/dev/null)" ]; then
+                kill "-$1" "$worker" && signaled=$worker
+                break
+            fi
+        done
+    done
+    wait $coordinator
+
+    if [ -z "$signaled" ]; then
+        echo "$2: no worker was signaled in the middle of a shard"
+        status=1
+    fi
+
+    if ! cmp -s "$WORK/serial.txt" "$WORK/parallel.txt"; then
+        echo "$2: the output of -P differs from the serial output"
+        diff "$WORK/serial.txt" "$WORK/parallel.txt" | head -20
+        status=1
+    fi
+
+    if ! diff -r "$WORK/serial" "$WORK/parallel" > /dev/null; then
+        echo "$2: the files written with -P differ from the serial files"
+        diff -rq "$WORK/serial" "$WORK/parallel" | head -20
+        status=1
+    fi
+
+    if [ -n "$(ls "$WORK/tmp")" ]; then
+        echo "$2: the scratch directories of the workers were left behind"
+        status=1
+    fi
+}
+
+# A worker that dies is detected when its socket closes
+check_signaled_worker KILL "Killed worker"
+
+# A worker that hangs without exiting is stopped when its shard passes the deadline
+check_signaled_worker STOP "Stopped worker"
+
+[ $status -eq 0 ] && echo "The -P output matches the serial output after killing a worker and stopping another"
+exit $status
@@ -9,6 +9,31 @@
 #include <ctype.h>
 #include "utils.h"
 #include "globals.h"
+#include "expression.h"
+
+/* Definition of a reserved word of the language */
+struct reserved_word {
+    char *name; /* The name of the reserved word */
+    word_kind kind; /* The kind of the reserved word */
+    int value; /* The register number, opcode or directive of the reserved word */
+};
+
+/* The reserved words of the language */
+static const struct reserved_word reserved_words[] = {
+    {"@r0", REGISTER_WORD, 0}, {"@r1", REGISTER_WORD, 1}, {"@r2", REGISTER_WORD, 2}, {"@r3", REGISTER_WORD, 3},
+    {"@r4", REGISTER_WORD, 4}, {"@r5", REGISTER_WORD, 5}, {"@r6", REGISTER_WORD, 6}, {"@r7", REGISTER_WORD, 7},
+    {"mov", OPCODE_WORD, MOV_OP}, {"cmp", OPCODE_WORD, CMP_OP}, {"add", OPCODE_WORD, ADD_OP}, {"sub", OPCODE_WORD, SUB_OP},
+    {"not", OPCODE_WORD, NOT_OP}, {"clr", OPCODE_WORD, CLR_OP}, {"lea", OPCODE_WORD, LEA_OP}, {"inc", OPCODE_WORD, INC_OP},
+    {"dec", OPCODE_WORD, DEC_OP}, {"jmp", OPCODE_WORD, JMP_OP}, {"bne", OPCODE_WORD, BNE_OP}, {"red", OPCODE_WORD, RED_OP},
+    {"prn", OPCODE_WORD, PRN_OP}, {"jsr", OPCODE_WORD, JSR_OP}, {"rts", OPCODE_WORD, RTS_OP}, {"stop", OPCODE_WORD, STOP_OP},
+    {".data", DIRECTIVE_WORD, DATA}, {".string", DIRECTIVE_WORD, STRING},
+    {".entry", DIRECTIVE_WORD, ENTRY}, {".extern", DIRECTIVE_WORD, EXTERN},
+    {".equ", DIRECTIVE_WORD, EQU}, {".set", DIRECTIVE_WORD, SET},
+    {"mcro", MACRO_KEYWORD_WORD, 0}, {"endmcro", MACRO_KEYWORD_WORD, 0}
+};
+
+/* Hash table of the reserved words: each slot holds the index of a reserved word plus one, or 0 if it is empty */
+static int reserved_word_slots[RESERVED_TABLE_SIZE];
 
 /**
  * Generates a new modified file name based on the original file name and the specified file type.
@@ -43,6 +68,12 @@ char *generate_new_filename(char *original, file_type type) {
         case FILE_EXTERNALS:
             strcat(modified_file_name, ".ext");
             break;
+        case FILE_LISTING:
+            strcat(modified_file_name, ".lst");
+            break;
+        case FILE_FOLDED:
+            strcat(modified_file_name, ".fld");
+            break;
         default:
             break;
     }
@@ -62,6 +93,9 @@ void print_error(err error) {
         case NOT_ENOUGH_PARAMS:
             printf("ERROR: Not enough parameters\n");
             break;
+        case UNKNOWN_OPTION:
+            printf("ERROR: Unknown option\n");
+            break;
         case MCR_EXP_FAILED:
             printf("ERROR: Macro expansion failed\n");
             break;
@@ -98,6 +132,27 @@ void print_error(err error) {
         case MCR_CANNOT_BE_DIR:
             printf("ERROR at line %d: Macro name cannot be directive name\n", line_num);
             break;
+        case MCR_CANNOT_BE_KEYWORD:
+            printf("ERROR at line %d: Macro name cannot be a macro keyword\n", line_num);
+            break;
+        case MCR_RECURSIVE:
+            printf("ERROR at line %d: Macro invokes itself (directly or through other macros)\n", line_num);
+            break;
+        case COND_MISSING_NAME:
+            printf("ERROR at line %d: Missing name after define/ifdef\n", line_num);
+            break;
+        case COND_EXTRANEOUS_TEXT:
+            printf("ERROR at line %d: Extraneous text in conditional directive\n", line_num);
+            break;
+        case COND_UNMATCHED:
+            printf("ERROR at line %d: else/endif without a matching ifdef\n", line_num);
+            break;
+        case COND_TOO_DEEP:
+            printf("ERROR at line %d: Conditional directives are nested too deeply\n", line_num);
+            break;
+        case COND_MISSING_ENDIF:
+            printf("ERROR at line %d: Missing endif\n", line_num);
+            break;
         case MCR_MISSING_NAME:
             printf("ERROR at line %d: Missing macro name\n", line_num);
             break;
@@ -143,6 +198,40 @@ void print_error(err error) {
         case DATA_NOT_NUM:
             printf("ERROR at line %d: .data argument is not a valid number\n", line_num);
             break;
+        case CONST_MISSING_PARAMS:
+            printf("ERROR at line %d: .equ/.set expects a name, a comma and an expression\n", line_num);
+            break;
+        case CONST_EXTRANEOUS_TEXT:
+            printf("ERROR at line %d: Extraneous text after the .equ/.set expression\n", line_num);
+            break;
+        case CONST_INVALID_EXPR:
+            printf("ERROR at line %d: Invalid constant expression\n", line_num);
+            break;
+        case CONST_REDEFINED:
+            printf("ERROR at line %d: Constant is already defined (only a .set constant can be redefined by .set)\n", line_num);
+            break;
+        case CONST_IS_SYMBOL:
+            printf("ERROR at line %d: Constant has the name of a symbol\n", line_num);
+            break;
+        case EXPR_UNDEFINED_SYMBOL:
+            printf("ERROR at line %d: Expression uses an undefined symbol\n", line_num);
+            break;
+        case EXPR_EXTERN_SYMBOL:
+            printf("ERROR at line %d: Expression cannot use an external symbol\n", line_num);
+            break;
+        case EXPR_DIV_BY_ZERO:
+            printf("ERROR at line %d: Division by zero in expression\n", line_num);
+            break;
+        case EXPR_TOO_DEEP:
+            printf("ERROR at line %d: Constants refer to each other in a cycle or are nested too deeply\n", line_num);
+            break;
+        case EXPR_OUT_OF_RANGE:
+            printf("ERROR at line %d: Expression value is out of range (-%d to %d)\n", line_num, MAX_EXPR_MAGNITUDE,
+                   MAX_EXPR_MAGNITUDE);
+            break;
+        case EXPR_RELOCATABLE_IMMEDIATE:
+            printf("ERROR at line %d: Immediate expression can only use labels in differences of addresses\n", line_num);
+            break;
         case DATA_MISSING_COMMA:
             printf("ERROR at line %d: .data missing comma\n", line_num);
             break;
@@ -194,6 +283,66 @@ void print_error(err error) {
         case SYMBOL_NOT_FOUND:
             printf("ERROR at line %d: Symbol not found in the symbol table\n", line_num);
             break;
+        case OBJ_VERIFY_FAILED:
+            printf("ERROR: Object verification failed\n");
+            break;
+        case OBJ_INVALID_HEADER:
+            printf("ERROR at line %d: Object file header must hold the code and data word counts\n", line_num);
+            break;
+        case OBJ_INVALID_WORD:
+            printf("ERROR at line %d: Object word is not two Base64 characters\n", line_num);
+            break;
+        case OBJ_WRONG_WORD_COUNT:
+            printf("ERROR at line %d: Object file word count does not match its header\n", line_num);
+            break;
+        case OBJ_INVALID_FIRST_WORD:
+            printf("ERROR at line %d: Invalid opcode, addressing modes or ARE in the first word of an instruction\n", line_num);
+            break;
+        case OBJ_TRUNCATED_INSTRUCTION:
+            printf("ERROR at line %d: Instruction extends past the code segment\n", line_num);
+            break;
+        case OBJ_INVALID_ARE:
+            printf("ERROR at line %d: Invalid ARE in an operand word\n", line_num);
+            break;
+        case OBJ_INVALID_REGISTER:
+            printf("ERROR at line %d: Invalid register operand word\n", line_num);
+            break;
+        case OBJ_INVALID_ADDRESS:
+            printf("ERROR at line %d: Address is outside the image\n", line_num);
+            break;
+        case OBJ_EXTERN_NOT_LISTED:
+            printf("ERROR at line %d: External operand word is not listed in the externals file\n", line_num);
+            break;
+        case OBJ_EXTERN_NOT_USED:
+            printf("ERROR at line %d: Externals file entry is not an external operand word\n", line_num);
+            break;
+        case OBJ_INVALID_ENTRY_ADDRESS:
+            printf("ERROR at line %d: Entries file address is outside the image\n", line_num);
+            break;
+        case OBJ_INVALID_SYMBOL_LINE:
+            printf("ERROR at line %d: Entries and externals file lines must hold a symbol and its address\n", line_num);
+            break;
+        case OBJ_DUPLICATE_ENTRY:
+            printf("ERROR at line %d: Entries file lists the symbol more than once\n", line_num);
+            break;
+        case OBJ_TOO_MANY_ENTRIES:
+            printf("ERROR at line %d: Entries file lists more symbols than an image can hold\n", line_num);
+            break;
+        case OBJ_DIFF_FAILED:
+            printf("ERROR: Object diff failed\n");
+            break;
+        case SHARD_FAILED:
+            printf("ERROR: Assembly failed in a worker process on every attempt\n");
+            break;
+        case LIMIT_WITHOUT_WORKERS:
+            printf("ERROR: The -B and -T options apply only with worker processes (-P)\n");
+            break;
+        case CACHE_UNAVAILABLE:
+            printf("ERROR: Cannot connect to the build cache\n");
+            break;
+        case CACHE_DAEMON_FAILED:
+            printf("ERROR: Cannot start the build cache on the given socket\n");
+            break;
         default:
             break;
     }
@@ -421,6 +570,89 @@ char *extract_remaining_seq(char *seq, char *seps) {
     return seq;
 }
 
+/**
+ * Classifies a word as a register, an operation, a directive, a macro keyword or an identifier with a single lookup
+ * in the reserved words hash table.
+ *
+ * @param word  The word to classify.
+ * @param value Where to store the register number, opcode or directive of a reserved word (may be NULL).
+ *
+ * @return The kind of the word, IDENTIFIER_WORD if it is not a reserved word.
+ *
+ * @remarks The hash table is built on the first call. The hash function has no collisions for the reserved words,
+ *          so each reserved word sits in its home slot and is found at the first probe. A word that is not reserved
+ *          probes forward from its home slot (linear probing) until the first empty slot.
+ */
+word_kind classify_word(char *word, int *value) {
+    static boolean is_table_built = FALSE;
+    int i, slot;
+
+    if (!is_table_built) {
+        /* Place each reserved word in its slot, using linear probing in case of a collision */
+        for (i = 0; i < (int)(sizeof(reserved_words) / sizeof(reserved_words[0])); i++) {
+            slot = hash_reserved_word(reserved_words[i].name);
+            while (reserved_word_slots[slot] != 0) {
+                slot = (slot + 1) % RESERVED_TABLE_SIZE;
+            }
+            reserved_word_slots[slot] = i + 1;
+        }
+        is_table_built = TRUE;
+    }
+
+    if (word == NULL || word[0] == '\0') {
+        return IDENTIFIER_WORD;
+    }
+
+    /* Probe the slots starting at the hash of the word until an empty slot is reached */
+    for (slot = hash_reserved_word(word); reserved_word_slots[slot] != 0; slot = (slot + 1) % RESERVED_TABLE_SIZE) {
+        const struct reserved_word *entry = &reserved_words[reserved_word_slots[slot] - 1];
+        if (strcmp(entry->name, word) == 0) {
+            if (value != NULL) {
+                *value = entry->value;
+            }
+            return entry->kind;
+        }
+    }
+
+    return IDENTIFIER_WORD;
+}
+
+/**
+ * Returns the name of a reserved word.
+ *
+ * @param kind  The kind of the reserved word.
+ * @param value The register number, opcode or directive of the reserved word.
+ *
+ * @return The name of the reserved word, or NULL if there is no such reserved word.
+ */
+char *get_reserved_word_name(word_kind kind, int value) {
+    int i;
+
+    for (i = 0; i < (int)(sizeof(reserved_words) / sizeof(reserved_words[0])); i++) {
+        if (reserved_words[i].kind == kind && reserved_words[i].value == value) {
+            return reserved_words[i].name;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Computes the slot of a word in the reserved words hash table.
+ *
+ * @param word The word to hash (not empty).
+ *
+ * @return The slot of the word, between 0 and RESERVED_TABLE_SIZE - 1.
+ */
+int hash_reserved_word(char *word) {
+    int len = strlen(word);
+
+    /* The first two characters, the last character and the length tell the reserved words apart */
+    /* The characters are hashed as unsigned, so a word with non-ASCII characters still gets a slot in the table */
+    return ((unsigned char)word[0] * 7 + (unsigned char)word[1] * 25 + (unsigned char)word[len - 1] * 17 + len) %
+           RESERVED_TABLE_SIZE;
+}
+
 /**
  * Checks if the given token represents a valid register.
  *
@@ -429,14 +661,7 @@ char *extract_remaining_seq(char *seq, char *seps) {
  * @return TRUE if the token is a valid register, FALSE otherwise.
  */
 boolean is_register(char *token) {
-    if (strlen(token) == REG_LEN && token[0] == '@' && token[1] == 'r' && isdigit(token[2])) {
-        int reg_index = token[2] - '0';
-        if (reg_index >= MIN_REG_INDEX && reg_index <= MAX_REG_INDEX) {
-            return TRUE;
-        }
-    }
-
-    return FALSE;
+    return classify_word(token, NULL) == REGISTER_WORD;
 }
 
 /**
@@ -449,22 +674,23 @@ boolean is_register(char *token) {
  */
 boolean is_symbol(char *token, boolean is_colon_expected) {
     int i;
-    int token_len = strlen(token);
+    int token_len;
+    char token_copy[MAX_LINE_LEN]; /* Tokens are taken from a single line, so they fit in a line buffer */
 
-    char *token_copy = (char *)malloc((token_len + 1) * sizeof(char));
-    if (token_copy == NULL) {
-        print_error(MEM_ALLOC_FAILED);
+    if (token == NULL) {
         return FALSE;
     }
 
-    if (token == NULL) {
+    token_len = strlen(token);
+    if (token_len >= MAX_LINE_LEN) {
+        print_error(SYMBOL_TOO_LONG);
         return FALSE;
     }
 
     strcpy(token_copy, token);
 
     /* Check if a colon (:) exists at the end of the token, if required */
-    if (is_colon_expected && token_copy[token_len - 1] != ':') {
+    if (is_colon_expected && (token_len == 0 || token_copy[token_len - 1] != ':')) {
         return FALSE;
     }
 
@@ -480,22 +706,19 @@ boolean is_symbol(char *token, boolean is_colon_expected) {
         return FALSE;
     }
 
-    /* Check if the token is a register name */
-    if (is_register(token_copy)) {
-        print_error(SYMBOL_CANNOT_BE_REG);
-        return FALSE;
-    }
-
-    /* Check if the token matches any operation name */
-    if (find_operation(token_copy) != NONE_OP) {
-        print_error(SYMBOL_CANNOT_BE_OP);
-        return FALSE;
-    }
-
-    /* Check if the token matches any directive name */
-    if (find_directive(token_copy) != NONE_DIR) {
-        print_error(SYMBOL_CANNOT_BE_DIR);
-        return FALSE;
+    /* Check if the token is a register, an operation or a directive name */
+    switch (classify_word(token_copy, NULL)) {
+        case REGISTER_WORD:
+            print_error(SYMBOL_CANNOT_BE_REG);
+            return FALSE;
+        case OPCODE_WORD:
+            print_error(SYMBOL_CANNOT_BE_OP);
+            return FALSE;
+        case DIRECTIVE_WORD:
+            print_error(SYMBOL_CANNOT_BE_DIR);
+            return FALSE;
+        default:
+            break;
     }
 
     /* Check if the first character of the token is alphabetic */
@@ -523,41 +746,9 @@ boolean is_symbol(char *token, boolean is_colon_expected) {
  * @return The corresponding opcode if found, or NONE_OP if no matching opcode is found.
  */
 opcode find_operation(char *op_name) {
-    if (strcmp(op_name, "mov") == 0) {
-        return MOV_OP;
-    } else if (strcmp(op_name, "cmp") == 0) {
-        return CMP_OP;
-    } else if (strcmp(op_name, "add") == 0) {
-        return ADD_OP;
-    } else if (strcmp(op_name, "sub") == 0) {
-        return SUB_OP;
-    } else if (strcmp(op_name, "not") == 0) {
-        return NOT_OP;
-    } else if (strcmp(op_name, "clr") == 0) {
-        return CLR_OP;
-    } else if (strcmp(op_name, "lea") == 0) {
-        return LEA_OP;
-    } else if (strcmp(op_name, "inc") == 0) {
-        return INC_OP;
-    } else if (strcmp(op_name, "dec") == 0) {
-        return DEC_OP;
-    } else if (strcmp(op_name, "jmp") == 0) {
-        return JMP_OP;
-    } else if (strcmp(op_name, "bne") == 0) {
-        return BNE_OP;
-    } else if (strcmp(op_name, "red") == 0) {
-        return RED_OP;
-    } else if (strcmp(op_name, "prn") == 0) {
-        return PRN_OP;
-    } else if (strcmp(op_name, "jsr") == 0) {
-        return JSR_OP;
-    } else if (strcmp(op_name, "rts") == 0) {
-        return RTS_OP;
-    } else if (strcmp(op_name, "stop") == 0) {
-        return STOP_OP;
-    } else {
-        return NONE_OP;
-    }
+    int value;
+
+    return classify_word(op_name, &value) == OPCODE_WORD ? (opcode)value : NONE_OP;
 }
 
 /**
@@ -568,17 +759,9 @@ opcode find_operation(char *op_name) {
  * @return The corresponding directive type if found, or NONE_DIR if no matching directive type is found.
  */
 directive find_directive(char *dir_name) {
-    if (strcmp(dir_name, ".data") == 0) {
-        return DATA;
-    } else if (strcmp(dir_name, ".string") == 0) {
-        return STRING;
-    } else if (strcmp(dir_name, ".entry") == 0) {
-        return ENTRY;
-    } else if (strcmp(dir_name, ".extern") == 0) {
-        return EXTERN;
-    } else {
-        return NONE_DIR;
-    }
+    int value;
+
+    return classify_word(dir_name, &value) == DIRECTIVE_WORD ? (directive)value : NONE_DIR;
 }
 
 /**
@@ -19,6 +19,7 @@
 #define MIN_REG_INDEX 0
 #define MAX_REG_INDEX 7
 #define ARE_BITS 2
+#define RESERVED_TABLE_SIZE 64
 
 /* Enumeration for file types */
 typedef enum file_type {
@@ -26,12 +27,15 @@ typedef enum file_type {
     FILE_MACRO,
     FILE_OBJECT,
     FILE_ENTRIES,
-    FILE_EXTERNALS
+    FILE_EXTERNALS,
+    FILE_LISTING,
+    FILE_FOLDED
 } file_type;
 
 /* Enumeration for error types */
 typedef enum err {
     NOT_ENOUGH_PARAMS,
+    UNKNOWN_OPTION,
     MCR_EXP_FAILED,
     FIRST_PASS_FAILED,
     SECOND_PASS_FAILED,
@@ -44,6 +48,13 @@ typedef enum err {
     MCR_CANNOT_BE_REG,
     MCR_CANNOT_BE_OP,
     MCR_CANNOT_BE_DIR,
+    MCR_CANNOT_BE_KEYWORD,
+    MCR_RECURSIVE,
+    COND_MISSING_NAME,
+    COND_EXTRANEOUS_TEXT,
+    COND_UNMATCHED,
+    COND_TOO_DEEP,
+    COND_MISSING_ENDIF,
     MCR_MISSING_NAME,
     MCR_MCRO_EXTRANEOUS_TEXT,
     MCR_ENDMCRO_EXTRANEOUS_TEXT,
@@ -59,6 +70,17 @@ typedef enum err {
     OP_INVALID_OPERANDS_MODE,
     DIR_MISSING_PARAMS,
     DATA_NOT_NUM,
+    CONST_MISSING_PARAMS,
+    CONST_EXTRANEOUS_TEXT,
+    CONST_INVALID_EXPR,
+    CONST_REDEFINED,
+    CONST_IS_SYMBOL,
+    EXPR_UNDEFINED_SYMBOL,
+    EXPR_EXTERN_SYMBOL,
+    EXPR_DIV_BY_ZERO,
+    EXPR_TOO_DEEP,
+    EXPR_OUT_OF_RANGE,
+    EXPR_RELOCATABLE_IMMEDIATE,
     DATA_MISSING_COMMA,
     DATA_EXTRANEOUS_TEXT,
     STRING_NOT_STR,
@@ -75,7 +97,27 @@ typedef enum err {
     ENTRY_CANNOT_BE_EXTERN,
     ENTRY_SYMBOL_NOT_FOUND,
     SYMBOL_ALREADY_EXISTS,
-    SYMBOL_NOT_FOUND
+    SYMBOL_NOT_FOUND,
+    OBJ_VERIFY_FAILED,
+    OBJ_INVALID_HEADER,
+    OBJ_INVALID_WORD,
+    OBJ_WRONG_WORD_COUNT,
+    OBJ_INVALID_FIRST_WORD,
+    OBJ_TRUNCATED_INSTRUCTION,
+    OBJ_INVALID_ARE,
+    OBJ_INVALID_REGISTER,
+    OBJ_INVALID_ADDRESS,
+    OBJ_EXTERN_NOT_LISTED,
+    OBJ_EXTERN_NOT_USED,
+    OBJ_INVALID_ENTRY_ADDRESS,
+    OBJ_INVALID_SYMBOL_LINE,
+    OBJ_DUPLICATE_ENTRY,
+    OBJ_TOO_MANY_ENTRIES,
+    OBJ_DIFF_FAILED,
+    SHARD_FAILED,
+    LIMIT_WITHOUT_WORKERS,
+    CACHE_UNAVAILABLE,
+    CACHE_DAEMON_FAILED
 } err;
 
 /* Enumeration for boolean values */
@@ -109,7 +151,10 @@ typedef enum opcode {
 } opcode;
 
 /* Enumeration for directive values */
-typedef enum directive { DATA, STRING, ENTRY, EXTERN, NONE_DIR = -1 } directive;
+typedef enum directive { DATA, STRING, ENTRY, EXTERN, EQU, SET, NONE_DIR = -1 } directive;
+
+/* Enumeration for the kinds of words returned by the reserved word classifier */
+typedef enum word_kind { REGISTER_WORD, OPCODE_WORD, DIRECTIVE_WORD, MACRO_KEYWORD_WORD, IDENTIFIER_WORD } word_kind;
 
 char *generate_new_filename(char *, file_type);
 void print_error(err);
@@ -121,6 +166,9 @@ boolean should_ignore(char *);
 boolean is_separator(char, char *);
 void copy_next_token(char *, char *, char *);
 char *extract_remaining_seq(char *, char *);
+word_kind classify_word(char *, int *);
+char *get_reserved_word_name(word_kind, int);
+int hash_reserved_word(char *);
 boolean is_register(char *);
 boolean is_symbol(char *, boolean);
 opcode find_operation(char *);
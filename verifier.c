@@ -0,0 +1,446 @@
+/**
+ * This file contains the implementation of the object verifier. The first word of every valid instruction is one of
+ * a few hundred 12-bit values, so the verifier computes them once from the checks of the first pass into a table that
+ * gives the length of the instruction each word starts (or 0 for an invalid word). Verifying the code segment is then
+ * a single linear pass: a table lookup per instruction and a check of the ARE and value of each operand word.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "verifier.h"
+#include "utils.h"
+#include "globals.h"
+#include "first_pass.h"
+#include "second_pass.h"
+#include "output_files.h"
+
+static unsigned char instruction_lengths[FIRST_WORD_VALUES]; /* The words of the instruction each first word starts, or 0 */
+static int base64_values[BASE64_VALUES]; /* The value of each Base64 character, or -1 for other characters */
+static boolean is_tables_ready; /* Indicates if the lookup tables were built */
+static int ext_lines[2 * MEM_SIZE]; /* For each offset of the image, the line of the externals file listing it, or 0 */
+static boolean is_ext_used[2 * MEM_SIZE]; /* Indicates if an offset listed in the externals file is an external operand */
+
+/**
+ * Builds the lookup tables of the verifier: the Base64 characters, and the length of the instruction started by each
+ * valid first word, for every opcode and addressing mode combination accepted by the first pass.
+ */
+void init_verifier_tables(void) {
+    const char base64_table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    const addressing_mode modes[] = {IMMEDIATE_ADDR, DIRECT_ADDR, REG_DIRECT_ADDR};
+    opcode op;
+    unsigned int word;
+    int i;
+    int j;
+
+    for (i = 0; i < BASE64_VALUES; i++) {
+        base64_values[i] = -1;
+    }
+    for (i = 0; base64_table[i] != '\0'; i++) {
+        base64_values[(unsigned char)base64_table[i]] = i;
+    }
+
+    for (op = MOV_OP; op <= STOP_OP; op = (opcode)(op + 1)) {
+        if (is_valid_operand_count(op, FALSE, FALSE)) {
+            word = encode_first_op_word(op, FALSE, FALSE, NONE_ADDR, NONE_ADDR);
+            instruction_lengths[word] = 1;
+        }
+
+        for (i = 0; i < 3; i++) {
+            if (is_valid_operand_count(op, TRUE, FALSE) && is_valid_mode_combination(op, modes[i], NONE_ADDR)) {
+                word = encode_first_op_word(op, TRUE, FALSE, modes[i], NONE_ADDR);
+                instruction_lengths[word] = 1 + get_additional_word_count(TRUE, FALSE, modes[i], NONE_ADDR);
+            }
+
+            for (j = 0; j < 3; j++) {
+                if (is_valid_operand_count(op, TRUE, TRUE) && is_valid_mode_combination(op, modes[i], modes[j])) {
+                    word = encode_first_op_word(op, TRUE, TRUE, modes[i], modes[j]);
+                    instruction_lengths[word] = 1 + get_additional_word_count(TRUE, TRUE, modes[i], modes[j]);
+                }
+            }
+        }
+    }
+
+    is_tables_ready = TRUE;
+}
+
+/**
+ * Returns the length of the instruction a first word starts.
+ *
+ * @param word The first word of the instruction.
+ *
+ * @return The number of words of the instruction, or 0 if the word is not a valid first word.
+ */
+int get_instruction_length(unsigned int word) {
+    if (!is_tables_ready) {
+        init_verifier_tables();
+    }
+
+    return word < FIRST_WORD_VALUES ? instruction_lengths[word] : 0;
+}
+
+/**
+ * Reads an object file into the code and data segments.
+ *
+ * @param name The name of the image (without an extension).
+ *
+ * @return TRUE if the object file is well formed, FALSE otherwise.
+ *
+ * @remarks The function sets the global variables 'ic', 'dc', 'code' and 'data', and 'line_num' for the error messages.
+ */
+boolean read_object_file(char *name) {
+    char *modified_filename_object = generate_new_filename(name, FILE_OBJECT);
+    FILE *object_fd = fopen(modified_filename_object, "r");
+    char line[MAX_LINE_LEN];
+    int first;
+    int second;
+    int count = 0;
+    boolean success = TRUE;
+
+    free(modified_filename_object);
+
+    if (!is_tables_ready) {
+        init_verifier_tables();
+    }
+
+    if (object_fd == NULL) {
+        print_error(CANNOT_OPEN_FILE);
+        return FALSE;
+    }
+
+    /* The rows are small, so a large buffer lets the whole file be read in a few reads */
+    setvbuf(object_fd, NULL, _IOFBF, VERIFY_BUFFER_SIZE);
+
+    line_num = 1;
+    if (fgets(line, MAX_LINE_LEN, object_fd) == NULL || sscanf(line, "%d %d", &ic, &dc) != 2 || ic < 0 || dc < 0 ||
+        ic > MEM_SIZE || dc > MEM_SIZE) {
+        print_error(OBJ_INVALID_HEADER);
+        fclose(object_fd);
+        return FALSE;
+    }
+
+    /* Each word is two Base64 characters, the high half first */
+    while (fgets(line, MAX_LINE_LEN, object_fd)) {
+        line_num++;
+        trim_end_whitespaces(line);
+
+        first = base64_values[(unsigned char)line[0]];
+        second = line[0] != '\0' ? base64_values[(unsigned char)line[1]] : -1;
+        if (first == -1 || second == -1 || line[2] != '\0') {
+            print_error(OBJ_INVALID_WORD);
+            success = FALSE;
+        }
+
+        if (count < ic) {
+            code[count] = ((unsigned int)first << SECOND_HALF_START) | (unsigned int)second;
+        } else if (count < ic + dc) {
+            data[count - ic] = ((unsigned int)first << SECOND_HALF_START) | (unsigned int)second;
+        }
+        count++;
+    }
+
+    if (count != ic + dc) {
+        print_error(OBJ_WRONG_WORD_COUNT);
+        success = FALSE;
+    }
+
+    fclose(object_fd);
+
+    return success;
+}
+
+/**
+ * Parses a line of an entries or externals file: a symbol followed by an address.
+ *
+ * @param line      The line to parse.
+ * @param name      The buffer the symbol is read into (MAX_LINE_LEN characters).
+ * @param address   Set to the address of the line.
+ *
+ * @return TRUE if the line is well formed, FALSE otherwise.
+ */
+boolean parse_symbol_line(char *line, char *name, unsigned int *address) {
+    char extra;
+    int value;
+
+    if (sscanf(line, "%80s %d %c", name, &value, &extra) != 2 || strlen(name) > MAX_SYMBOL_LEN || value < 0) {
+        print_error(OBJ_INVALID_SYMBOL_LINE);
+        return FALSE;
+    }
+
+    *address = (unsigned int)value;
+    return TRUE;
+}
+
+/**
+ * Reads the externals file of an image, if there is one, and records the operand words it lists.
+ *
+ * @param name The name of the image (without an extension).
+ *
+ * @return TRUE if the externals file is well formed, FALSE otherwise.
+ */
+boolean read_externals_file(char *name) {
+    char *modified_filename_externals = generate_new_filename(name, FILE_EXTERNALS);
+    FILE *externals_fd = fopen(modified_filename_externals, "r");
+    char line[MAX_LINE_LEN];
+    char symbol[MAX_LINE_LEN];
+    unsigned int address;
+    boolean success = TRUE;
+    int i;
+
+    free(modified_filename_externals);
+
+    for (i = 0; i < 2 * MEM_SIZE; i++) {
+        ext_lines[i] = 0;
+        is_ext_used[i] = FALSE;
+    }
+
+    /* An image without external symbols has no externals file */
+    if (externals_fd == NULL) {
+        return TRUE;
+    }
+
+    line_num = 0;
+    while (fgets(line, MAX_LINE_LEN, externals_fd)) {
+        line_num++;
+
+        if (!parse_symbol_line(line, symbol, &address)) {
+            success = FALSE;
+        } else if (address < MEM_START || address >= (unsigned int)(MEM_START + ic)) {
+            /* Only the operand words of the code segment can refer to an external symbol */
+            print_error(OBJ_EXTERN_NOT_USED);
+            success = FALSE;
+        } else {
+            ext_lines[address - MEM_START] = line_num;
+        }
+    }
+
+    fclose(externals_fd);
+
+    return success;
+}
+
+/**
+ * Reads the entries file of an image, if there is one, and checks that its addresses are in the image.
+ *
+ * @param name The name of the image (without an extension).
+ *
+ * @return TRUE if the entries file is well formed, FALSE otherwise.
+ */
+boolean read_entries_file(char *name) {
+    char *modified_filename_entries = generate_new_filename(name, FILE_ENTRIES);
+    FILE *entries_fd = fopen(modified_filename_entries, "r");
+    char line[MAX_LINE_LEN];
+    char symbol[MAX_LINE_LEN];
+    unsigned int address;
+    boolean success = TRUE;
+
+    free(modified_filename_entries);
+
+    /* An image without entry symbols has no entries file */
+    if (entries_fd == NULL) {
+        return TRUE;
+    }
+
+    line_num = 0;
+    while (fgets(line, MAX_LINE_LEN, entries_fd)) {
+        line_num++;
+
+        if (!parse_symbol_line(line, symbol, &address)) {
+            success = FALSE;
+        } else if (address < MEM_START || address >= (unsigned int)(MEM_START + ic + dc)) {
+            print_error(OBJ_INVALID_ENTRY_ADDRESS);
+            success = FALSE;
+        }
+    }
+
+    fclose(entries_fd);
+
+    return success;
+}
+
+/**
+ * Checks an operand word of an instruction.
+ *
+ * @param offset    The offset of the word in the code segment.
+ * @param mode      The addressing mode of the operand.
+ * @param is_dest   Indicates if the operand is the destination operand.
+ *
+ * @return TRUE if the word is valid, FALSE otherwise.
+ */
+boolean verify_operand_word(int offset, addressing_mode mode, boolean is_dest) {
+    unsigned int word = code[offset];
+    are are_val = (are)extract_bits(word, 0, ARE_BITS - 1);
+    unsigned int address = word >> ARE_BITS;
+
+    line_num = offset + 2;
+
+    switch (mode) {
+        case IMMEDIATE_ADDR:
+            if (are_val != ABSOLUTE) {
+                print_error(OBJ_INVALID_ARE);
+                return FALSE;
+            }
+            return TRUE;
+
+        case DIRECT_ADDR:
+            /* An external operand holds no address, and its word must be listed in the externals file */
+            if (are_val == EXTERNAL) {
+                if (address != DEFAULT_ADDR || ext_lines[offset] == 0) {
+                    print_error(OBJ_EXTERN_NOT_LISTED);
+                    return FALSE;
+                }
+                is_ext_used[offset] = TRUE;
+                return TRUE;
+            }
+
+            if (are_val != RELOCATABLE) {
+                print_error(OBJ_INVALID_ARE);
+                return FALSE;
+            }
+
+            if (address < MEM_START || address >= (unsigned int)(MEM_START + ic + dc)) {
+                print_error(OBJ_INVALID_ADDRESS);
+                return FALSE;
+            }
+            return TRUE;
+
+        case REG_DIRECT_ADDR:
+            return verify_register_word(offset, !is_dest, is_dest);
+
+        default:
+            break;
+    }
+
+    return FALSE;
+}
+
+/**
+ * Checks a register operand word, which holds a source register, a destination register, or both.
+ *
+ * @param offset    The offset of the word in the code segment.
+ * @param has_src   Indicates if the word holds a source register.
+ * @param has_dest  Indicates if the word holds a destination register.
+ *
+ * @return TRUE if the word is valid, FALSE otherwise.
+ */
+boolean verify_register_word(int offset, boolean has_src, boolean has_dest) {
+    unsigned int word = code[offset];
+    unsigned int src_reg = extract_bits(word, ARE_BITS + BITS_IN_REG, ARE_BITS + 2 * BITS_IN_REG - 1);
+    unsigned int dest_reg = extract_bits(word, ARE_BITS, ARE_BITS + BITS_IN_REG - 1);
+
+    line_num = offset + 2;
+
+    if (extract_bits(word, 0, ARE_BITS - 1) != ABSOLUTE) {
+        print_error(OBJ_INVALID_ARE);
+        return FALSE;
+    }
+
+    /* The field of a missing register must be empty */
+    if ((has_src ? src_reg > MAX_REG_INDEX : src_reg != 0) || (has_dest ? dest_reg > MAX_REG_INDEX : dest_reg != 0)) {
+        print_error(OBJ_INVALID_REGISTER);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * Checks the code segment in a single linear pass: the first word of each instruction gives its length and the
+ * addressing modes of its operands, whose words are checked in turn. Then each word listed in the externals file must
+ * have been found to be an external operand.
+ *
+ * @return TRUE if the code segment is valid, FALSE otherwise.
+ */
+boolean verify_code(void) {
+    addressing_mode src_mode;
+    addressing_mode dest_mode;
+    unsigned int word;
+    int length;
+    int next;
+    int i = 0;
+    boolean success = TRUE;
+
+    while (i < ic) {
+        word = code[i];
+        length = get_instruction_length(word);
+        line_num = i + 2;
+
+        /* Skip a single word after an invalid first word, to report the following instructions too */
+        if (length == 0) {
+            print_error(OBJ_INVALID_FIRST_WORD);
+            success = FALSE;
+            i++;
+            continue;
+        }
+
+        if (i + length > ic) {
+            print_error(OBJ_TRUNCATED_INSTRUCTION);
+            success = FALSE;
+            break;
+        }
+
+        src_mode = (addressing_mode)extract_bits(word, SRC_MODE_START_POS, SRC_MODE_END_POS);
+        dest_mode = (addressing_mode)extract_bits(word, DEST_MODE_START_POS, DEST_MODE_END_POS);
+        next = i + 1;
+
+        /* Two register operands share a single word */
+        if (src_mode == REG_DIRECT_ADDR && dest_mode == REG_DIRECT_ADDR) {
+            if (!verify_register_word(next, TRUE, TRUE)) {
+                success = FALSE;
+            }
+        } else {
+            if (src_mode != 0 && !verify_operand_word(next++, src_mode, FALSE)) {
+                success = FALSE;
+            }
+            if (dest_mode != 0 && !verify_operand_word(next, dest_mode, TRUE)) {
+                success = FALSE;
+            }
+        }
+
+        i += length;
+    }
+
+    for (i = 0; i < ic; i++) {
+        if (ext_lines[i] != 0 && !is_ext_used[i]) {
+            line_num = ext_lines[i];
+            print_error(OBJ_EXTERN_NOT_USED);
+            success = FALSE;
+        }
+    }
+
+    return success;
+}
+
+/**
+ * Verifies an image written by the assembler: its object file, and its entries and externals files if it has them.
+ *
+ * @param name The name of the image (without an extension).
+ *
+ * @return TRUE if the image is valid, FALSE otherwise.
+ */
+boolean verify_object(char *name) {
+    boolean success;
+
+    success = read_object_file(name);
+
+    /* The code is only checked once the image and its externals were read correctly */
+    if (success && !read_externals_file(name)) {
+        success = FALSE;
+    }
+
+    if (success && !read_entries_file(name)) {
+        success = FALSE;
+    }
+
+    if (success && !verify_code()) {
+        success = FALSE;
+    }
+
+    if (success) {
+        printf("%s: Object verified: %d code words, %d data words\n", name, ic, dc);
+    } else {
+        print_error(OBJ_VERIFY_FAILED);
+    }
+
+    return success;
+}
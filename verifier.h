@@ -0,0 +1,27 @@
+/**
+ * This header file declares the functions of the object verifier. The verifier loads an image written by the
+ * assembler (.ob with its optional .ent and .ext files) and checks every code word against the rules the assembler
+ * encodes by, in a single linear pass over the code segment using lookup tables built from the first pass checks.
+ */
+
+#ifndef ASM_VERIFIER_H
+#define ASM_VERIFIER_H
+
+#include "utils.h"
+
+#define FIRST_WORD_VALUES 4096 /* The number of values of a 12-bit word */
+#define BASE64_VALUES 256 /* The number of values of a character */
+#define VERIFY_BUFFER_SIZE 65536
+
+void init_verifier_tables(void);
+int get_instruction_length(unsigned int);
+boolean read_object_file(char *);
+boolean read_externals_file(char *);
+boolean read_entries_file(char *);
+boolean parse_symbol_line(char *, char *, unsigned int *);
+boolean verify_operand_word(int, addressing_mode, boolean);
+boolean verify_register_word(int, boolean, boolean);
+boolean verify_code(void);
+boolean verify_object(char *);
+
+#endif